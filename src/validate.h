@@ -31,10 +31,15 @@
 #include <array>
 #include <bitset>
 #include <cctype>
+#include <cerrno>
 #include <cmath>
 #include <charconv>
+#include <chrono>
 #include <complex>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <ctime>
 #include <filesystem>
 #include <fstream>
 #include <functional>
@@ -42,6 +47,7 @@
 #include <iostream>
 #include <limits>
 #include <map>
+#include <memory>
 #include <numeric>
 #include <optional>
 #include <queue>
@@ -57,6 +63,30 @@
 #include <variant>
 #include <vector>
 
+#if !defined(STREAM_FALLBACK) && !defined(__unix__) && !defined(__APPLE__)
+	#define STREAM_FALLBACK
+#endif
+#ifndef STREAM_FALLBACK
+	#include <fcntl.h>
+	#include <poll.h>
+	#include <sys/mman.h>
+	#include <sys/socket.h>
+	#include <sys/stat.h>
+	#include <sys/un.h>
+	#include <sys/wait.h>
+	#include <csignal>
+	#include <unistd.h>
+	#ifdef __APPLE__
+		#include <mach-o/dyld.h>
+	#endif
+#endif
+#if !defined(SIMD_FALLBACK) && !defined(__SSE2__) && !defined(_M_X64)
+	#define SIMD_FALLBACK
+#endif
+#ifndef SIMD_FALLBACK
+	#include <immintrin.h>
+#endif
+
 
 //============================================================================//
 // Basic definitions and constants                                            //
@@ -74,6 +104,8 @@ constexpr Real operator ""_real(long double value) {return static_cast<Real>(val
 
 // settings which can be overwritten before the include!
 //#define DOUBLE_FALLBACK
+//#define STREAM_FALLBACK
+//#define SIMD_FALLBACK
 namespace Settings {
 	namespace details {
 		using RandomEngine                              = std::mt19937_64;
@@ -81,6 +113,7 @@ namespace Settings {
 		constexpr bool DEFAULT_CASE_LOWER               = true;
 		constexpr int DEFAULT_PRECISION                 = 6;
 		constexpr Real DEFAULT_EPS                      = 1e-6_real;
+		constexpr Integer DEFAULT_MAX_TOKEN_LENGTH      = 1 << 26;
 
 		[[noreturn]] void exitVerdict(int exitCode) {
 			//throw exitCode;
@@ -96,6 +129,7 @@ using Settings::LARGE;
 using Settings::DEFAULT_CASE_LOWER;
 using Settings::DEFAULT_PRECISION;
 using Settings::DEFAULT_EPS;
+using Settings::DEFAULT_MAX_TOKEN_LENGTH;
 using Settings::exitVerdict;
 
 // useful constants
@@ -136,11 +170,41 @@ constexpr std::string_view EMPTY_COMMAND                = "";
 constexpr std::string_view COMMAND_PREFIX               = "--";
 constexpr std::string_view CONSTRAINT_COMMAND           = "--constraints_file";
 constexpr std::string_view SEED_COMMAND                 = "--seed";
+constexpr std::string_view OUTPUT_LIMIT_COMMAND         = "--output_limit";
+constexpr std::string_view JURY_CACHE_COMMAND           = "--jury_cache";
+constexpr std::string_view SERVER_COMMAND               = "--server";
+constexpr std::string_view BATCH_COMMAND                = "--batch";
+constexpr std::string_view JOBS_COMMAND                 = "--jobs";
+constexpr std::string_view MEMO_COMMAND                 = "--memo";
+constexpr std::string_view LATENCY_COMMAND              = "--latency";
+constexpr std::string_view RESPONSE_TIMEOUT_COMMAND     = "--response_timeout";
+constexpr std::string_view TRANSCRIPT_COMMAND           = "--transcript";
+constexpr std::string_view REPLAY_COMMAND               = "--replay";
 constexpr std::string_view TEXT_ELLIPSIS                = "[...]";
 constexpr auto REGEX_OPTIONS                            = std::regex::nosubs | std::regex::optimize;
-inline const std::regex INTEGER_REGEX("0|-?[1-9][0-9]*", REGEX_OPTIONS);
-inline const std::regex REAL_REGEX("[+-]?(([0-9]*\\.[0-9]+)|([0-9]+\\.)|([0-9]+))([eE][+-]?[0-9]+)?", REGEX_OPTIONS);
-inline const std::regex STRICT_REAL_REGEX("-?(0|([1-9][0-9]*))\\.?[0-9]*", REGEX_OPTIONS);
+
+// each regex is compiled on first use by a function local static
+inline const std::regex& integerRegex() {
+	static const std::regex regex("0|-?[1-9][0-9]*", REGEX_OPTIONS);
+	return regex;
+}
+
+inline const std::regex& realRegex() {
+	static const std::regex regex("[+-]?(([0-9]*\\.[0-9]+)|([0-9]+\\.)|([0-9]+))([eE][+-]?[0-9]+)?", REGEX_OPTIONS);
+	return regex;
+}
+
+inline const std::regex& strictRealRegex() {
+	static const std::regex regex("-?(0|([1-9][0-9]*))\\.?[0-9]*", REGEX_OPTIONS);
+	return regex;
+}
+
+// the constants compile their regex at startup, define LAZY_REGEX before the include to drop them
+#ifndef LAZY_REGEX
+inline const std::regex& INTEGER_REGEX = integerRegex();
+inline const std::regex& REAL_REGEX = realRegex();
+inline const std::regex& STRICT_REAL_REGEX = strictRealRegex();
+#endif
 
 static_assert(2'000'000'000'000'000'000_int < LARGE / 2, "LARGE too small");
 static_assert(LARGE <= std::numeric_limits<Integer>::max() / 2, "LARGE too big");
@@ -175,6 +239,32 @@ namespace details {
 	template<typename T, std::size_t N>
 	struct IsStdArray<std::array<T, N>> : std::true_type {};
 
+	template<typename T>
+	struct IsCharacter : std::false_type {};
+
+	template<>
+	struct IsCharacter<char> : std::true_type {};
+
+	template<>
+	struct IsCharacter<signed char> : std::true_type {};
+
+	template<>
+	struct IsCharacter<unsigned char> : std::true_type {};
+
+	template<>
+	struct IsCharacter<wchar_t> : std::true_type {};
+
+	template<>
+	struct IsCharacter<char16_t> : std::true_type {};
+
+	template<>
+	struct IsCharacter<char32_t> : std::true_type {};
+
+#ifdef __cpp_char8_t
+	template<>
+	struct IsCharacter<char8_t> : std::true_type {};
+#endif
+
 	template<typename T, typename = void>
 	struct IsTupleLike : std::false_type {};
 
@@ -202,8 +292,11 @@ namespace Verdicts {
 			return exitCode;
 		}
 
+		// may replace the exit code of every verdict before the program exits
+		static inline int (*beforeExit)(int exitCode) = nullptr;
+
 		[[noreturn]] void exit() const {
-			exitVerdict(exitCode);
+			exitVerdict(beforeExit ? beforeExit(exitCode) : exitCode);
 		}
 
 		friend void operator<<(std::ostream& os, const Verdict& v) {
@@ -239,16 +332,223 @@ public:
 
 namespace details {
 	NullStream nullStream;
+
+#ifndef STREAM_FALLBACK
+	// returns false if not everything could be written
+	bool writeAll(int fd, std::string_view data) {
+		while (!data.empty()) {
+			auto res = ::write(fd, data.data(), data.size());
+			if (res < 0 and errno == EINTR) continue;
+			if (res <= 0) return false;
+			data.remove_prefix(static_cast<std::size_t>(res));
+		}
+		return true;
+	}
+#endif
+}
+
+namespace details {
+	// measures how long the other side of an interaction needs to respond to a message
+	class RoundTimer final {
+		using Clock = std::chrono::steady_clock;
+
+		Clock::time_point start;
+		Clock::time_point sentAt;
+		bool waiting;
+		std::vector<Integer> responseTimes;	// in nanoseconds
+		std::unique_ptr<std::ofstream> trace;
+
+		Integer nanoseconds(Clock::duration d) const {
+			return static_cast<Integer>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+		}
+
+	public:
+		RoundTimer() : start(Clock::now()), waiting(false) {}
+		// the trace contains two 64-bit integers for each round:
+		// the time the message was sent and the time the response arrived in ns since construction
+		explicit RoundTimer(const std::filesystem::path& path) : RoundTimer() {
+			trace = std::make_unique<std::ofstream>(path, std::ios::binary);
+			judgeAssert<std::runtime_error>(trace->good(), "RoundTimer(): Could not open File: " + path.string());
+		}
+
+		RoundTimer(const RoundTimer&) = delete;
+		RoundTimer& operator=(const RoundTimer&) = delete;
+
+		void sent() {
+			sentAt = Clock::now();
+			waiting = true;
+		}
+
+		void received() {
+			if (!waiting) return;
+			waiting = false;
+			Clock::time_point now = Clock::now();
+			responseTimes.push_back(nanoseconds(now - sentAt));
+			if (trace) {
+				std::array<std::int64_t, 2> record = {nanoseconds(sentAt - start), nanoseconds(now - start)};
+				trace->write(reinterpret_cast<const char*>(record.data()), sizeof(record));
+			}
+		}
+
+		Integer rounds() const {
+			return static_cast<Integer>(responseTimes.size());
+		}
+
+		// rounds, total, mean and 99th percentile of the response times and the cpu time of this process in us
+		std::string summary() const {
+			Integer total = std::accumulate(responseTimes.begin(), responseTimes.end(), Integer(0));
+			Integer mean = responseTimes.empty() ? 0 : total / rounds();
+			Integer p99 = 0;
+			if (!responseTimes.empty()) {
+				std::vector<Integer> sorted = responseTimes;
+				auto it = sorted.begin() + (99 * rounds() + 99) / 100 - 1;
+				std::nth_element(sorted.begin(), it, sorted.end());
+				p99 = *it;
+			}
+			Integer cpu = static_cast<Integer>(1'000'000.0l * static_cast<Real>(std::clock()) / CLOCKS_PER_SEC);
+			return "rounds: " + std::to_string(rounds()) +
+			       ", response time: total " + std::to_string(total / 1000) +
+			       "us, mean " + std::to_string(mean / 1000) +
+			       "us, p99 " + std::to_string(p99 / 1000) +
+			       "us, cpu time: " + std::to_string(cpu) + "us";
+		}
+	};
+
+	// a transcript starts with TRANSCRIPT_MAGIC followed by the messages of an interaction,
+	// each message is the direction (TO_TEAM or FROM_TEAM), its length as 32-bit little endian and the data
+	constexpr std::string_view TRANSCRIPT_MAGIC = "VTRANS1\n";
+
+	class TranscriptWriter final {
+		std::ofstream file;
+		char direction;
+		std::string message;	// consecutive data in the same direction is merged
+
+		void finish() {
+			for (std::size_t pos = 0; pos < message.size();) {
+				std::size_t length = std::min<std::size_t>(message.size() - pos, std::numeric_limits<std::uint32_t>::max());
+				std::array<char, 5> header = {direction};
+				for (std::size_t i = 0; i < 4; i++) header[i + 1] = static_cast<char>((length >> (8 * i)) & 0xFF);
+				file.write(header.data(), header.size());
+				file.write(message.data() + pos, static_cast<std::streamsize>(length));
+				pos += length;
+			}
+			message.clear();
+		}
+
+	public:
+		static constexpr char TO_TEAM = '>';
+		static constexpr char FROM_TEAM = '<';
+
+		explicit TranscriptWriter(const std::filesystem::path& path) : file(path, std::ios::binary), direction(TO_TEAM) {
+			judgeAssert<std::runtime_error>(file.good(), "TranscriptWriter(): Could not open File: " + path.string());
+			file.write(TRANSCRIPT_MAGIC.data(), TRANSCRIPT_MAGIC.size());
+		}
+
+		TranscriptWriter(const TranscriptWriter&) = delete;
+		TranscriptWriter& operator=(const TranscriptWriter&) = delete;
+
+		~TranscriptWriter() {
+			finish();
+		}
+
+		void record(char direction_, std::string_view data) {
+			if (direction_ != direction) finish();
+			direction = direction_;
+			message.append(data);
+		}
+	};
+}
+
+// ends a message, an OutputStream writes everything buffered so far with a single write()
+std::ostream& FLUSH(std::ostream& os) {
+	return os << std::flush;
 }
 
 class OutputStream final {
+	// files and streams that opted in collect their output in a large buffer which is written in big chunks
+	static constexpr std::size_t BUFFER_SIZE = 1 << 16;
+
 	std::unique_ptr<std::ofstream> managed;
 	std::ostream* os;
+	int fd = -1;			// if set, the buffer is written directly to this file descriptor once buffering is enabled
+	bool pending = false;	// if output bypassed the buffer, os must be flushed before writing to fd
+	bool buffered = false;
+	bool classic = false;
+	std::string buffer;
+	details::RoundTimer* timer = nullptr;	// notified about every message and the response to it
+	details::TranscriptWriter* transcript = nullptr;	// records everything written and the responses to it
 
 	void init() {
 		*os << std::boolalpha;
 		*os << std::fixed;
 		*os << std::setprecision(DEFAULT_PRECISION);
+		// other streams like std::cout may also be written directly, buffering would reorder that output
+		buffered = managed != nullptr;
+		classic = os->getloc() == std::locale::classic();
+		if (buffered) buffer.reserve(BUFFER_SIZE);
+	}
+
+	void write(std::string_view s) {
+		if (!buffered) {
+			if (transcript) transcript->record(details::TranscriptWriter::TO_TEAM, s);
+			os->write(s.data(), static_cast<std::streamsize>(s.size()));
+			// unbuffered streams have no fd, pending only tells the timer that a message was written
+			if (timer) pending = true;
+		} else {
+			buffer.append(s);
+			if (buffer.size() >= BUFFER_SIZE) drain();
+		}
+	}
+
+	// writes the buffer to the underlying stream or file descriptor
+	void drain() {
+		if (buffer.empty()) return;
+		if (transcript) transcript->record(details::TranscriptWriter::TO_TEAM, buffer);
+	#ifndef STREAM_FALLBACK
+		if (fd >= 0) {
+			if (pending) os->flush();
+			pending = false;
+			details::writeAll(fd, buffer);
+			buffer.clear();
+			return;
+		}
+	#endif
+		os->write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+		buffer.clear();
+	}
+
+	// the fast path is only taken if it produces exactly the same output as the std::ostream
+	bool plain(bool real) const {
+		std::ios_base::fmtflags flags = os->flags();
+		if (!classic or os->width() != 0 or (flags & std::ios_base::showpos)) return false;
+		if (real) return (flags & std::ios_base::floatfield) == std::ios_base::fixed and !(flags & std::ios_base::showpoint);
+		else return (flags & std::ios_base::basefield) == std::ios_base::dec;
+	}
+
+	template<typename T>
+	bool writeNumber(T x) {
+		std::array<char, 64> tmp;
+		if constexpr (std::is_floating_point_v<T>) {
+			if (!plain(true) or !std::isfinite(x) or os->precision() < 0) return false;
+			int precision = static_cast<int>(os->precision());
+		#ifdef __cpp_lib_to_chars
+			auto [end, ec] = std::to_chars(tmp.data(), tmp.data() + tmp.size(), x, std::chars_format::fixed, precision);
+			if (ec != std::errc()) return false;
+			write(std::string_view(tmp.data(), static_cast<std::size_t>(end - tmp.data())));
+		#else
+			int length;
+			if constexpr (std::is_same_v<T, long double>) length = std::snprintf(tmp.data(), tmp.size(), "%.*Lf", precision, x);
+			else length = std::snprintf(tmp.data(), tmp.size(), "%.*f", precision, static_cast<double>(x));
+			if (length < 0 or static_cast<std::size_t>(length) >= tmp.size()) return false;
+			write(std::string_view(tmp.data(), static_cast<std::size_t>(length)));
+		#endif
+		} else {
+			if (!plain(false)) return false;
+			auto [end, ec] = std::to_chars(tmp.data(), tmp.data() + tmp.size(), x);
+			if (ec != std::errc()) return false;
+			write(std::string_view(tmp.data(), static_cast<std::size_t>(end - tmp.data())));
+		}
+		return true;
 	}
 
 public:
@@ -258,13 +558,77 @@ public:
 		judgeAssert<std::runtime_error>(os->good(), "OutputStream(): Could not open File: " + path.string());
 		init();
 	}
-
-	OutputStream(OutputStream&& other) = default;
-	OutputStream& operator=(OutputStream&& other) = default;
+	// fd_ must be the file descriptor os_ writes to, the buffer is then written without going through os_
+	explicit OutputStream(std::ostream& os_, int fd_) : os(&os_), fd(fd_) {init();}
+
+	OutputStream(OutputStream&& other) : managed(std::move(other.managed)), os(other.os), fd(other.fd), pending(other.pending),
+	                                     buffered(other.buffered), classic(other.classic), buffer(std::move(other.buffer)), timer(other.timer),
+	                                     transcript(other.transcript) {
+		other.os = &details::nullStream;
+		other.fd = -1;
+		other.buffered = false;
+		other.buffer.clear();
+	}
+	OutputStream& operator=(OutputStream&& other) {
+		if (this != &other) {
+			drain();
+			managed = std::move(other.managed);
+			os = other.os;
+			fd = other.fd;
+			pending = other.pending;
+			buffered = other.buffered;
+			classic = other.classic;
+			buffer = std::move(other.buffer);
+			timer = other.timer;
+			transcript = other.transcript;
+			other.os = &details::nullStream;
+			other.fd = -1;
+			other.buffered = false;
+			other.buffer.clear();
+		}
+		return *this;
+	}
 
 	OutputStream(const OutputStream&) = delete;
 	OutputStream& operator=(const OutputStream&) = delete;
 
+	~OutputStream() {
+		drain();
+	}
+
+	// writes the buffered output and flushes the underlying stream
+	void flush() {
+		bool sent = pending or !buffer.empty();
+		drain();
+		if (!buffered or fd < 0 or pending) os->flush();
+		pending = false;
+		if (timer and sent) timer->sent();
+	}
+
+	// collects the output in a large buffer, the output may then be reordered with direct writes to the underlying stream
+	void useBuffer(bool enable = true) {
+		drain();
+		os->flush();
+		pending = false;
+		buffered = enable;
+		if (buffered) buffer.reserve(BUFFER_SIZE);
+	}
+
+	// every flush starts a round which ends when a tied InputStream receives input
+	void timeRounds(details::RoundTimer* timer_) {
+		timer = timer_;
+	}
+
+	void recordTranscript(details::TranscriptWriter* transcript_) {
+		transcript = transcript_;
+	}
+
+	// called by a tied InputStream with all input it received
+	void received(std::string_view data) {
+		if (timer) timer->received();
+		if (transcript) transcript->record(details::TranscriptWriter::FROM_TEAM, data);
+	}
+
 	template<typename L, typename R>
 	OutputStream& operator<<(const std::pair<L, R>& t) {
 		return *this << t.first << DEFAULT_SEPARATOR << t.second;
@@ -281,20 +645,53 @@ public:
 		              (details::IsContainer<T>{} and !details::HasOstreamOperator<T>{})) {
 			return join(std::begin(x), std::end(x), DEFAULT_SEPARATOR);
 		} else {
+			if constexpr (std::is_same_v<T, char>) {
+				if (os->width() == 0) return write(std::string_view(&x, 1)), *this;
+			} else if constexpr (std::is_same_v<T, std::string> or std::is_same_v<T, std::string_view> or
+			                     std::is_same_v<std::decay_t<T>, const char*> or std::is_same_v<std::decay_t<T>, char*>) {
+				if (os->width() == 0) return write(x), *this;
+			} else if constexpr (std::is_floating_point_v<T> or (std::is_integral_v<T> and
+			                     !std::is_same_v<T, bool> and !details::IsCharacter<T>{})) {
+				if (writeNumber(x)) return *this;
+			}
+			if constexpr (!std::is_same_v<T, Verdicts::Verdict>) {
+				if (transcript) {
+					// the transcript must see everything, so format into the buffer
+					// and copy back the format in case x was a manipulator
+					std::ostringstream formatted;
+					formatted.copyfmt(*os);
+					formatted << x;
+					os->copyfmt(formatted);
+					write(formatted.str());
+					return *this;
+				}
+			}
+			drain();
 			*os << x;
+			pending = true;
 			return *this;
 		}
 	}
 
 	OutputStream& operator<<(std::ostream& (*manip)(std::ostream&)) {
-		*os << manip;
+		using Manipulator = std::ostream& (*)(std::ostream&);
+		if (manip == static_cast<Manipulator>(std::endl)) {
+			write("\n");
+			flush();
+		} else if (manip == static_cast<Manipulator>(std::flush) or manip == FLUSH) {
+			flush();
+		} else {
+			drain();
+			*os << manip;
+			pending = true;
+		}
 		return *this;
 	}
 
 	template<typename Tuple, std::size_t... Is>
 	OutputStream& join(const Tuple& t, std::index_sequence<Is...> /**/, char separator) {
 		static_assert(std::tuple_size_v<Tuple> == sizeof...(Is));
-		if (separator != NOSEP) ((*os << (Is == 0 ? std::string_view() : std::string_view(&separator, 1)), *this << std::get<Is>(t)), ...);
+		if (separator != NOSEP) ((write(Is == 0 ? std::string_view() : std::string_view(&separator, 1)), *this << std::get<Is>(t)), ...);
 		else ((*this << std::get<Is>(t)), ...);
 		return *this;
 	}
@@ -302,7 +699,7 @@ public:
 	template<typename T>
 	OutputStream& join(T first, T last, char separator) {
 		for (auto it = first; it != last; it++) {
-			if (it != first and separator != NOSEP) *os << separator;
+			if (it != first and separator != NOSEP) write(std::string_view(&separator, 1));
 			*this << *it;
 		}
 		return *this;
@@ -549,6 +946,38 @@ struct boolean {
 	}
 };
 
+// a contiguous row-major rows x cols matrix
+template<typename T>
+class Matrix {
+	std::size_t rows_, cols_;
+	std::vector<T> data_;
+public:
+	Matrix() : rows_(0), cols_(0) {}
+	Matrix(std::size_t rows, std::size_t cols, const T& value = T()) : rows_(rows), cols_(cols), data_(rows * cols, value) {}
+
+	std::size_t rows() const {return rows_;}
+	std::size_t cols() const {return cols_;}
+	std::size_t size() const {return data_.size();}
+
+	T* data() {return data_.data();}
+	const T* data() const {return data_.data();}
+
+	T* operator[](std::size_t row) {return data() + row * cols_;}
+	const T* operator[](std::size_t row) const {return data() + row * cols_;}
+
+	auto begin() {return data_.begin();}
+	auto begin() const {return data_.begin();}
+	auto end() {return data_.end();}
+	auto end() const {return data_.end();}
+
+	bool operator==(const Matrix& other) const {
+		return rows_ == other.rows_ and cols_ == other.cols_ and data_ == other.data_;
+	}
+	bool operator!=(const Matrix& other) const {
+		return !(*this == other);
+	}
+};
+
 // the lambda capture makes it harder to cal this with anything else then a named variable
 #define allOf(x) [&x](){return std::begin(x);}(), std::end(x)
 
@@ -916,6 +1345,28 @@ namespace details {
 		return false;
 	}
 
+	// index of the first pair with !floatEqual(given[i], expected[i], ...) or n
+	std::size_t firstUnequal(const Real* given, const Real* expected, std::size_t n, Real floatAbsTol, Real floatRelTol) {
+		judgeAssert<std::domain_error>(floatAbsTol >= 0.0_real, "floatEqual(): floatAbsTol must be positive!");
+		judgeAssert<std::domain_error>(floatRelTol >= 0.0_real, "floatEqual(): floatRelTol must be positive!");
+		// a branch free check that only accepts finite values and avoids the division,
+		// the relative tolerance is shrunk slightly so that rounding cannot accept more than floatEqual()
+		constexpr Real INF = std::numeric_limits<Real>::infinity();
+		const Real relTol = floatRelTol * (1 - 4 * std::numeric_limits<Real>::epsilon());
+		bool valid = true;
+		for (std::size_t i = 0; i < n; i++) {
+			Real absDiff = std::abs(given[i] - expected[i]);
+			Real reference = std::abs(expected[i]);
+			bool finite = (std::abs(given[i]) < INF) & (reference < INF);
+			valid &= finite & ((absDiff <= floatAbsTol) | (absDiff <= relTol * reference));
+		}
+		if (valid) return n;
+		for (std::size_t i = 0; i < n; i++) {
+			if (!floatEqual(given[i], expected[i], floatAbsTol, floatRelTol)) return i;
+		}
+		return n;
+	}
+
 	constexpr boolean<std::size_t> stringEqual(std::string_view a, std::string_view b, bool caseSensitive) {
 		std::size_t i = 0;
 		for (; i < a.size() and i < b.size(); i++) {
@@ -975,19 +1426,204 @@ namespace details {
 		return true;
 	}
 
+	enum class TokenResult {VALID, MISMATCH, OUT_OF_RANGE};
+
+	// single pass replacement for regex_match(s, INTEGER_REGEX) and parse<Integer>(s)
+	constexpr TokenResult parseInteger(std::string_view s, Integer& res) {
+		constexpr std::size_t MAX_DIGITS = std::numeric_limits<UInteger>::digits10;
+		bool negative = !s.empty() and s[0] == '-';
+		std::string_view digits = s.substr(negative ? 1 : 0);
+		if (digits.empty() or !isDigit(digits[0])) return TokenResult::MISMATCH;
+		if (digits[0] == '0') {
+			if (negative or digits.size() > 1) return TokenResult::MISMATCH;
+			res = 0;
+			return TokenResult::VALID;
+		}
+		UInteger value = 0;
+		for (std::size_t i = 0; i < digits.size(); i++) {
+			if (!isDigit(digits[i])) return TokenResult::MISMATCH;
+			if (i < MAX_DIGITS) value = value * 10 + static_cast<UInteger>(digits[i] - '0');
+		}
+		UInteger limit = static_cast<UInteger>(std::numeric_limits<Integer>::max()) + (negative ? 1 : 0);
+		if (digits.size() > MAX_DIGITS or value > limit) return TokenResult::OUT_OF_RANGE;
+		res = static_cast<Integer>(negative ? 0 - value : value);
+		return TokenResult::VALID;
+	}
+
+	// table driven replacement for REAL_REGEX and STRICT_REAL_REGEX
+	// state 0 is the error state and state 1 the start state
+	template<std::size_t N>
+	struct RealAutomaton {
+		enum Kind : unsigned char {NONE, SIGN, INT, FRAC, EXP_SIGN, EXP};
+		// char classes: '0', '1'-'9', '.', '+', '-', 'e' or 'E', other
+		static constexpr std::size_t CLASSES = 7;
+
+		std::array<std::array<unsigned char, CLASSES>, N> next;
+		std::array<Kind, N> kind;
+		std::array<bool, N> accept;
+	};
+
+	constexpr std::array<unsigned char, 256> REAL_CHAR_CLASS = [](){
+		std::array<unsigned char, 256> res = {};
+		for (std::size_t c = 0; c < res.size(); c++) res[c] = 6;
+		for (char c : DIGITS) res[static_cast<unsigned char>(c)] = 1;
+		res['0'] = 0;
+		res['.'] = 2;
+		res['+'] = 3;
+		res['-'] = 4;
+		res['e'] = 5;
+		res['E'] = 5;
+		return res;
+	}();
+
+	// [+-]?(([0-9]*\.[0-9]+)|([0-9]+\.)|([0-9]+))([eE][+-]?[0-9]+)?
+	constexpr RealAutomaton<10> REAL_AUTOMATON = {{{
+		//0  1-9 .  +  -  eE other
+		{0, 0, 0, 0, 0, 0, 0},	// error
+		{3, 3, 4, 2, 2, 0, 0},	// start
+		{3, 3, 4, 0, 0, 0, 0},	// sign
+		{3, 3, 5, 0, 0, 7, 0},	// integer part
+		{6, 6, 0, 0, 0, 0, 0},	// dot without integer part
+		{6, 6, 0, 0, 0, 7, 0},	// dot after integer part
+		{6, 6, 0, 0, 0, 7, 0},	// fractional part
+		{9, 9, 0, 8, 8, 0, 0},	// exponent marker
+		{9, 9, 0, 0, 0, 0, 0},	// exponent sign
+		{9, 9, 0, 0, 0, 0, 0},	// exponent
+	}}, {
+		RealAutomaton<10>::NONE, RealAutomaton<10>::NONE, RealAutomaton<10>::SIGN,
+		RealAutomaton<10>::INT, RealAutomaton<10>::NONE, RealAutomaton<10>::NONE,
+		RealAutomaton<10>::FRAC, RealAutomaton<10>::NONE, RealAutomaton<10>::EXP_SIGN,
+		RealAutomaton<10>::EXP,
+	}, {
+		false, false, false, true, false, true, true, false, false, true,
+	}};
+
+	// -?(0|([1-9][0-9]*))\.?[0-9]*
+	constexpr RealAutomaton<8> STRICT_REAL_AUTOMATON = {{{
+		//0  1-9 .  +  -  eE other
+		{0, 0, 0, 0, 0, 0, 0},	// error
+		{3, 4, 0, 0, 2, 0, 0},	// start
+		{3, 4, 0, 0, 0, 0, 0},	// sign
+		{5, 5, 6, 0, 0, 0, 0},	// leading zero
+		{4, 4, 6, 0, 0, 0, 0},	// integer part
+		{5, 5, 0, 0, 0, 0, 0},	// digits after leading zero
+		{7, 7, 0, 0, 0, 0, 0},	// dot
+		{7, 7, 0, 0, 0, 0, 0},	// fractional part
+	}}, {
+		RealAutomaton<8>::NONE, RealAutomaton<8>::NONE, RealAutomaton<8>::SIGN,
+		RealAutomaton<8>::INT, RealAutomaton<8>::INT, RealAutomaton<8>::INT,
+		RealAutomaton<8>::NONE, RealAutomaton<8>::FRAC,
+	}, {
+		false, false, false, true, true, true, true, true,
+	}};
+
+	// largest k such that 10^k is exactly representable as Real
+	constexpr std::size_t MAX_EXACT_POW10 = [](){
+		constexpr int bits = std::min(std::numeric_limits<Real>::digits, std::numeric_limits<UInteger>::digits);
+		std::size_t k = 0;
+		UInteger pow5 = 1;
+		while (pow5 <= std::numeric_limits<UInteger>::max() / 5 and
+		       (bits == std::numeric_limits<UInteger>::digits or pow5 * 5 < (1_uint << bits))) {
+			pow5 *= 5;
+			k++;
+		}
+		return k;
+	}();
+
+	constexpr std::array<Real, MAX_EXACT_POW10 + 1> EXACT_POW10 = [](){
+		std::array<Real, MAX_EXACT_POW10 + 1> res = {};
+		res[0] = 1;
+		for (std::size_t i = 1; i < res.size(); i++) res[i] = res[i - 1] * 10;
+		return res;
+	}();
+
+	// validates and converts in one pass, only uses parse<Real>() if the result may not be exact
+	template<std::size_t N>
+	TokenResult parseReal(std::string_view s, Real& res, Integer& decimals, const RealAutomaton<N>& automaton) {
+		constexpr std::size_t MAX_DIGITS = std::numeric_limits<UInteger>::digits10;
+		constexpr Integer MAX_EXPONENT = 1'000'000;
+		bool negative = false;
+		bool negativeExponent = false;
+		bool exact = true;
+		UInteger mantissa = 0;
+		std::size_t digits = 0;
+		Integer exponent = 0;
+		Integer shift = 0;
+		decimals = 0;
+
+		unsigned char state = 1;
+		for (char c : s) {
+			state = automaton.next[state][REAL_CHAR_CLASS[static_cast<unsigned char>(c)]];
+			switch (automaton.kind[state]) {
+				case RealAutomaton<N>::NONE:
+					if (state == 0) return TokenResult::MISMATCH;
+					break;
+				case RealAutomaton<N>::SIGN:
+					negative = c == '-';
+					break;
+				case RealAutomaton<N>::INT:
+				case RealAutomaton<N>::FRAC: {
+					bool fractional = automaton.kind[state] == RealAutomaton<N>::FRAC;
+					if (fractional) decimals++;
+					if (mantissa == 0 and c == '0') {
+						if (fractional) shift--;
+					} else if (digits < MAX_DIGITS) {
+						mantissa = mantissa * 10 + static_cast<UInteger>(c - '0');
+						digits++;
+						if (fractional) shift--;
+					} else {
+						exact &= c == '0';
+						if (!fractional) shift++;
+					}
+					break;
+				}
+				case RealAutomaton<N>::EXP_SIGN:
+					negativeExponent = c == '-';
+					break;
+				case RealAutomaton<N>::EXP:
+					exponent = std::min(exponent * 10 + (c - '0'), MAX_EXPONENT);
+					break;
+			}
+		}
+		if (!automaton.accept[state]) return TokenResult::MISMATCH;
+
+		shift += negativeExponent ? -exponent : exponent;
+		bool exactMantissa = std::numeric_limits<Real>::digits >= std::numeric_limits<UInteger>::digits or
+		                     mantissa < (1_uint << std::min(std::numeric_limits<Real>::digits, std::numeric_limits<UInteger>::digits - 1));
+		Integer maxShift = static_cast<Integer>(MAX_EXACT_POW10);
+		if (mantissa == 0) {
+			res = 0;
+		} else if (exact and exactMantissa and shift >= -maxShift and shift <= maxShift) {
+			res = static_cast<Real>(mantissa);
+			if (shift < 0) res /= EXACT_POW10[static_cast<std::size_t>(-shift)];
+			else res *= EXACT_POW10[static_cast<std::size_t>(shift)];
+		} else {
+			return parse<Real>(s, res) ? TokenResult::VALID : TokenResult::OUT_OF_RANGE;
+		}
+		if (negative) res = -res;
+		return TokenResult::VALID;
+	}
+
+	TokenResult parseReal(std::string_view s, Real& res) {
+		Integer decimals = 0;
+		return parseReal(s, res, decimals, REAL_AUTOMATON);
+	}
+
+	TokenResult parseRealStrict(std::string_view s, Real& res, Integer& decimals) {
+		return parseReal(s, res, decimals, STRICT_REAL_AUTOMATON);
+	}
+
 }
 
 boolean<Integer> isInteger(const std::string& s) {
-	if (!std::regex_match(s, INTEGER_REGEX)) return boolean<Integer>(false);
 	Integer value = 0;
-	if (!details::parse<Integer>(s, value)) return boolean<Integer>(false);
+	if (details::parseInteger(s, value) != details::TokenResult::VALID) return boolean<Integer>(false);
 	return boolean<Integer>(true, value);
 }
 
 boolean<Real> isReal(const std::string& s) {
-	if (!std::regex_match(s, REAL_REGEX)) return boolean<Real>(false);
 	Real value = 0;
-	if (!details::parse<Real>(s, value)) return boolean<Real>(false);
+	if (details::parseReal(s, value) != details::TokenResult::VALID) return boolean<Real>(false);
 	return boolean<Real>(true, value);
 }
 
@@ -2306,202 +2942,1487 @@ public:
 };
 
 //============================================================================//
-// custom input stream                                                        //
+// input sources                                                              //
 //============================================================================//
-class InputStream final {
-	std::unique_ptr<std::ifstream> managed;
-	std::istream* in;
-	bool spaceSensitive, caseSensitive;
-	OutputStream* out;
-	Verdicts::Verdict onFail;
-	Real floatAbsTol;
-	Real floatRelTol;
-
-	void init() {
-		if (spaceSensitive) *in >> std::noskipws;
-		else *in >> std::skipws;
+namespace details {
+	constexpr bool isSpace(char c) {
+		return c == ' ' or (c >= '\t' and c <= '\r');
 	}
 
-	void checkIn() {
-		judgeAssert<std::runtime_error>(in != nullptr, "InputStream: not initialized!");
+#ifndef SIMD_FALLBACK
+	inline unsigned firstSetBit(unsigned mask) {
+	#ifdef _MSC_VER
+		unsigned long res = 0;
+		_BitScanForward(&res, mask);
+		return static_cast<unsigned>(res);
+	#else
+		return static_cast<unsigned>(__builtin_ctz(mask));
+	#endif
 	}
 
-public:
-	InputStream() = default;
-	explicit InputStream(const std::filesystem::path& path,
-	                     bool spaceSensitive_,
-	                     bool caseSensitive_,
-	                     OutputStream& out_,
-	                     Verdicts::Verdict onFail_,
-	                     Real floatAbsTol_ = DEFAULT_EPS,
-	                     Real floatRelTol_ = DEFAULT_EPS) :
-	                     managed(std::make_unique<std::ifstream>(path)),
-	                     in(managed.get()),
-	                     spaceSensitive(spaceSensitive_),
-	                     caseSensitive(caseSensitive_),
-	                     out(&out_),
-	                     onFail(onFail_),
-	                     floatAbsTol(floatAbsTol_),
-	                     floatRelTol(floatRelTol_) {
-		judgeAssert<std::runtime_error>(managed->good(), "InputStream: Could not open File: " + path.string());
-		init();
+	// bit i is set iff isSpace(it[i])
+	inline unsigned spaceMask16(const char* it) {
+		__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+		__m128i control = _mm_sub_epi8(c, _mm_set1_epi8('\t'));
+		__m128i isControl = _mm_cmpeq_epi8(_mm_min_epu8(control, _mm_set1_epi8('\r' - '\t')), control);
+		__m128i isBlank = _mm_cmpeq_epi8(c, _mm_set1_epi8(' '));
+		return static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(isControl, isBlank)));
 	}
-	explicit InputStream(std::istream& in_,
-	                     bool spaceSensitive_,
-	                     bool caseSensitive_,
-	                     OutputStream& out_,
-	                     Verdicts::Verdict onFail_,
-	                     Real floatAbsTol_ = DEFAULT_EPS,
-	                     Real floatRelTol_ = DEFAULT_EPS) :
-	                     managed(),
-	                     in(&in_),
-	                     spaceSensitive(spaceSensitive_),
-	                     caseSensitive(caseSensitive_),
-	                     out(&out_),
-	                     onFail(onFail_),
-	                     floatAbsTol(floatAbsTol_),
-	                     floatRelTol(floatRelTol_) {
-		init();
+
+	#ifdef __AVX2__
+	inline unsigned spaceMask32(const char* it) {
+		__m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it));
+		__m256i control = _mm256_sub_epi8(c, _mm256_set1_epi8('\t'));
+		__m256i isControl = _mm256_cmpeq_epi8(_mm256_min_epu8(control, _mm256_set1_epi8('\r' - '\t')), control);
+		__m256i isBlank = _mm256_cmpeq_epi8(c, _mm256_set1_epi8(' '));
+		return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_or_si256(isControl, isBlank)));
 	}
+	#endif
+#endif
 
-	InputStream(InputStream&& other) = default;
-	InputStream& operator=(InputStream&& other) = default;
+	// length of the longest common prefix
+	inline std::size_t commonPrefix(std::string_view a, std::string_view b) {
+		constexpr std::size_t BLOCK = 1 << 12;
+		std::size_t n = std::min(a.size(), b.size());
+		std::size_t i = 0;
+		while (i + BLOCK <= n and std::memcmp(a.data() + i, b.data() + i, BLOCK) == 0) i += BLOCK;
+		while (i < n and a[i] == b[i]) i++;
+		return i;
+	}
+
+	// returns the first it in [begin, end) with isSpace(*it) == SPACE or end
+	template<bool SPACE>
+	const char* findSpace(const char* begin, const char* end) {
+		const char* it = begin;
+		// most tokens and separators are short
+		for (const char* stop = begin + std::min<std::ptrdiff_t>(end - begin, 4); it != stop; it++) {
+			if (isSpace(*it) == SPACE) return it;
+		}
+	#ifndef SIMD_FALLBACK
+		#ifdef __AVX2__
+		for (; end - it >= 32; it += 32) {
+			unsigned mask = spaceMask32(it);
+			if constexpr (!SPACE) mask = ~mask;
+			if (mask != 0) return it + firstSetBit(mask);
+		}
+		#endif
+		for (; end - it >= 16; it += 16) {
+			unsigned mask = spaceMask16(it);
+			if constexpr (!SPACE) mask = ~mask & 0xFFFFu;
+			if (mask != 0) return it + firstSetBit(mask);
+		}
+	#endif
+		while (it != end and isSpace(*it) != SPACE) it++;
+		return it;
+	}
 
-	InputStream(const InputStream&) = delete;
-	InputStream& operator=(const InputStream&) = delete;
+	// read() may block but should return as soon as any data is available
+	class ByteSource {
+	public:
+		virtual ~ByteSource() = default;
+		virtual std::size_t read(char* buffer, std::size_t size) = 0;
+		virtual std::optional<std::string_view> mapped() const {return std::nullopt;}
+		// waits at most milliseconds until read() would not block, returns false on timeout
+		virtual bool wait(Integer /**/) {return true;}
+	};
 
-	void eof() {
-		checkIn();
-		if (!spaceSensitive) *in >> std::ws;
-		if (in->peek() != std::char_traits<char>::eof()) {
-			in->get();
-			*out << "Missing EOF!";
-			fail();
+	class StreamSource final : public ByteSource {
+		std::unique_ptr<std::istream> managed;
+		std::istream* in;
+	public:
+		explicit StreamSource(std::istream& in_) : managed(), in(&in_) {}
+		explicit StreamSource(std::unique_ptr<std::istream> in_) : managed(std::move(in_)), in(managed.get()) {}
+
+		std::size_t read(char* buffer, std::size_t size) override {
+			std::streambuf* buf = in->rdbuf();
+			// sgetc() blocks until at least one char is available
+			if (buf->sgetc() == std::char_traits<char>::eof()) return 0;
+			std::streamsize available = std::max<std::streamsize>(1, buf->in_avail());
+			available = std::min(available, static_cast<std::streamsize>(size));
+			return static_cast<std::size_t>(buf->sgetn(buffer, available));
 		}
-	}
+	};
 
-	void noteof() {
-		checkIn();
-		if (!spaceSensitive) *in >> std::ws;
-		if (in->peek() == std::char_traits<char>::eof()) {
-			*out << "Unexpected EOF!" << onFail;
+#ifndef STREAM_FALLBACK
+	class FileDescriptorSource final : public ByteSource {
+		int fd;
+		bool owned;
+		std::istream* stream;	// the stream this fd belongs to, its tie() is flushed before reading
+
+		void flushTie() {
+			if (stream and stream->tie()) stream->tie()->flush();
 		}
-	}
 
-	void space() {
-		if (spaceSensitive) {
-			noteof();
-			if (in->get() != std::char_traits<char>::to_int_type(SPACE)) {
-				*out << "Missing space!";
-				fail();
-			}
+	public:
+		explicit FileDescriptorSource(int fd_, bool owned_, std::istream* stream_ = nullptr) : fd(fd_), owned(owned_), stream(stream_) {}
+
+		~FileDescriptorSource() override {
+			if (owned) ::close(fd);
 		}
-	}
 
-	void newline() {
-		if (spaceSensitive) {
-			noteof();
-			if (in->get() != std::char_traits<char>::to_int_type(NEWLINE)) {
-				*out << "Missing newline!";
-				fail();
+		std::size_t read(char* buffer, std::size_t size) override {
+			flushTie();
+			while (true) {
+				auto res = ::read(fd, buffer, size);
+				if (res >= 0) return static_cast<std::size_t>(res);
+				judgeAssert<std::runtime_error>(errno == EINTR, "InputStream: Could not read input!");
 			}
 		}
-	}
 
-private:
-	void check(const std::string& token, const std::regex& pattern) {
-		if (!std::regex_match(token, pattern)) {
-			*out << "Token \"" << token << "\" does not match pattern!";
-			fail();
+		bool wait(Integer milliseconds) override {
+			flushTie();
+			pollfd request = {fd, POLLIN, 0};
+			int timeout = static_cast<int>(std::min<Integer>(milliseconds, std::numeric_limits<int>::max()));
+			while (true) {
+				int res = ::poll(&request, 1, timeout);
+				if (res >= 0) return res > 0;
+				judgeAssert<std::runtime_error>(errno == EINTR, "InputStream: Could not poll input!");
+			}
 		}
-	}
+	};
 
-	std::function<void()> checkSeparator(char separator) {
-		if (separator == SPACE) return [this](){space();};
-		if (separator == NEWLINE) return [this](){newline();};
-		judgeAssert<std::invalid_argument>(false, "InputStream: Separator must be ' '  or '\\n'!");
-		return {};
-	}
+	class MappedSource final : public ByteSource {
+		void* data;
+		std::size_t size;
+	public:
+		explicit MappedSource(void* data_, std::size_t size_) : data(data_), size(size_) {}
 
-	template<typename T>
-	T parse(const std::string& s) {
-		T res = {};
-		if (!details::parse<T>(s, res)) {
-			*out << "Could not parse token \"" << s << "\"!";
-			fail();
+		~MappedSource() override {
+			if (size > 0) ::munmap(data, size);
 		}
-		return res;
-	}
-
-	std::string getline() {
-		//using this is descouraged!
-		judgeAssert<std::invalid_argument>(spaceSensitive, "InputStream: getline() must be used with case sensitive input!");
-		noteof();
-		std::string res;
-		std::getline(*in, res, NEWLINE);
-		if (in->eof()) noteof();
-		return res;
-	}
 
-public:
-	std::string string() {
-		noteof();
-		if (spaceSensitive and !std::isgraph(in->peek())) {
-			in->get();
-			*out << "Invalid whitespace!";
-			fail();
+		std::size_t read(char* /**/, std::size_t /**/) override {
+			return 0;
 		}
-		std::string res;
-		*in >> res;
-		if (res.empty()) {
-			*out << "Unexpected EOF!" << onFail;
+
+		std::optional<std::string_view> mapped() const override {
+			if (size == 0) return std::string_view();
+			return std::string_view(static_cast<const char*>(data), size);
 		}
-		if (!caseSensitive) toDefaultCase(res);
-		return res;
-	}
+	};
 
-	std::string string(Integer lower, Integer upper) {
-		std::string t = string();
-		Integer length = static_cast<Integer>(t.size());
-		if (length < lower or length >= upper) {
-			*out << "String length " << length << " out of range [" << lower << ", " << upper << ")!";
-			fail();
+	// memory maps regular files and reads everything else with read()
+	std::unique_ptr<ByteSource> openSource(int fd, bool owned, std::istream* stream = nullptr) {
+		struct stat info = {};
+		if (::fstat(fd, &info) == 0 and S_ISREG(info.st_mode) and ::lseek(fd, 0, SEEK_CUR) == 0) {
+			std::size_t size = static_cast<std::size_t>(info.st_size);
+			void* data = size == 0 ? nullptr : ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (data != MAP_FAILED) {
+				if (owned) ::close(fd);
+				return std::make_unique<MappedSource>(data, size);
+			}
 		}
-		return t;
+		return std::make_unique<FileDescriptorSource>(fd, owned, stream);
 	}
+#endif
 
-	std::string string(Integer lower, Integer upper, Constraint& constraint) {
-		std::string res = string(lower, upper);
-		constraint.log(lower, upper, res);
-		return res;
+	std::unique_ptr<ByteSource> openSource(const std::filesystem::path& path) {
+	#ifndef STREAM_FALLBACK
+		int fd = ::open(path.c_str(), O_RDONLY);
+		judgeAssert<std::runtime_error>(fd >= 0, "InputStream: Could not open File: " + path.string());
+		return openSource(fd, true);
+	#else
+		auto in = std::make_unique<std::ifstream>(path, std::ios::binary);
+		judgeAssert<std::runtime_error>(in->good(), "InputStream: Could not open File: " + path.string());
+		return std::make_unique<StreamSource>(std::move(in));
+	#endif
 	}
 
-	std::string string(const std::regex& pattern) {
-		std::string t = string();
-		check(t, pattern);
-		return t;
+	std::unique_ptr<ByteSource> openSource(std::istream& in) {
+	#ifndef STREAM_FALLBACK
+		if (&in == &std::cin) return openSource(STDIN_FILENO, false, &in);
+	#endif
+		return std::make_unique<StreamSource>(in);
 	}
 
-	std::string string(const std::regex& pattern, Integer lower, Integer upper) {
-		std::string t = string(lower, upper);
-		check(t, pattern);
-		return t;
-	}
+	// a buffer over a ByteSource that keeps everything from the current position in memory
+	// and tracks lines while reading, so that errors can be located without a second pass
+	class InputBuffer final {
+		static constexpr std::size_t CHUNK_SIZE = 1 << 20;
+		static constexpr std::size_t CONTEXT_SIZE = 1 << 12;
 
-	std::string string(const std::regex& pattern, Integer lower, Integer upper, Constraint& constraint) {
-		std::string res = string(pattern, lower, upper);
-		constraint.log(lower, upper, res);
+	public:
+		// the last consumed token or char
+		struct Mark {
+			UInteger line, lineStart, begin, end;
+		};
+
+	private:
+		std::unique_ptr<ByteSource> source;
+		std::vector<char> storage;
+		const char* first;
+		const char* current;
+		const char* last;
+		UInteger offset;	// absolute position of first
+		bool done;
+		UInteger line, lineStart;
+		Mark lastMark;
+		UInteger limit;		// total number of bytes that may be read
+		bool exceeded;
+		std::function<void()> onLimit;
+		Integer waitTime;	// milliseconds to wait for the source, negative means no limit
+		std::function<void()> onTimeout;
+		OutputStream* tied;	// flushed before blocking on the source
+
+		// reads more data but keeps [current, last) and up to CONTEXT_SIZE bytes of the current line
+		bool refill() {
+			if (done) {
+				if (exceeded and onLimit) onLimit();
+				return false;
+			}
+			const char* keep = current - std::min(static_cast<std::size_t>(current - first), CONTEXT_SIZE);
+			if (lineStart > offset + static_cast<UInteger>(keep - first)) {
+				keep = first + static_cast<std::size_t>(lineStart - offset);
+			}
+			std::size_t kept = static_cast<std::size_t>(last - keep);
+			std::size_t pos = static_cast<std::size_t>(current - keep);
+			if (kept > 0 and keep != storage.data()) std::memmove(storage.data(), keep, kept);
+			offset += static_cast<UInteger>(keep - first);
+			if (storage.size() - kept < CHUNK_SIZE / 2) {
+				storage.resize(std::max(2 * storage.size(), kept + CHUNK_SIZE));
+			}
+			// never read more than one byte over the limit
+			UInteger end = offset + kept;
+			std::size_t request = storage.size() - kept;
+			if (limit - end < request) request = static_cast<std::size_t>(limit - end) + 1;
+			if (tied) tied->flush();
+			if (waitTime >= 0 and !source->wait(waitTime) and onTimeout) onTimeout();
+			std::size_t read = source->read(storage.data() + kept, request);
+			if (tied and read > 0) tied->received(std::string_view(storage.data() + kept, read));
+			if (end + read > limit) {
+				read = static_cast<std::size_t>(limit - end);
+				exceeded = true;
+			}
+			first = storage.data();
+			current = first + pos;
+			last = first + kept + read;
+			done = read == 0 or exceeded;
+			if (read == 0 and exceeded and onLimit) onLimit();
+			return read != 0;
+		}
+
+		void startLine(const char* begin) {
+			line++;
+			lineStart = offset + static_cast<UInteger>(begin - first);
+		}
+
+		void mark(UInteger begin) {
+			lastMark = {line, lineStart, begin, tell()};
+		}
+
+	public:
+		explicit InputBuffer(std::unique_ptr<ByteSource> source_) : source(std::move(source_)),
+		                                                             offset(0), line(1), lineStart(0), lastMark{1, 0, 0, 0},
+		                                                             limit(std::numeric_limits<UInteger>::max() - 1), exceeded(false), waitTime(-1), tied(nullptr) {
+			if (auto content = source->mapped()) {
+				first = current = content->data();
+				last = first + content->size();
+				done = true;
+			} else {
+				first = current = last = storage.data();
+				done = false;
+			}
+		}
+
+		InputBuffer(const InputBuffer&) = delete;
+		InputBuffer& operator=(const InputBuffer&) = delete;
+
+		// onLimit_ gets called as soon as more than limit_ bytes are requested, it should not return
+		void limitLength(UInteger limit_, std::function<void()> onLimit_) {
+			judgeAssert<std::logic_error>(limit_ >= tell(), "InputStream: input was already read beyond the limit!");
+			limit = std::min(limit_, std::numeric_limits<UInteger>::max() - 1);
+			onLimit = std::move(onLimit_);
+			if (offset + static_cast<UInteger>(last - first) > limit) {
+				last = first + static_cast<std::size_t>(limit - offset);
+				exceeded = done = true;
+			}
+		}
+
+		// afterwards, reading stops silently at the limit
+		void ignoreLimit() {
+			onLimit = nullptr;
+		}
+
+		// onTimeout_ gets called if the source provides no data for milliseconds, it should not return
+		void limitWaitTime(Integer milliseconds, std::function<void()> onTimeout_) {
+			waitTime = milliseconds;
+			onTimeout = std::move(onTimeout_);
+		}
+
+		void tie(OutputStream* out) {
+			tied = out;
+		}
+
+		int peek() {
+			if (current == last and !refill()) return std::char_traits<char>::eof();
+			return std::char_traits<char>::to_int_type(*current);
+		}
+
+		int get() {
+			int res = peek();
+			if (current != last) {
+				current++;
+				mark(tell() - 1);
+				if (res == '\n') startLine(current);
+			}
+			return res;
+		}
+
+		bool consume(char c) {
+			if (peek() != std::char_traits<char>::to_int_type(c)) return false;
+			current++;
+			mark(tell() - 1);
+			if (c == '\n') startLine(current);
+			return true;
+		}
+
+		void skipSpace() {
+			while (true) {
+				// most separators are short, only long runs of whitespace are skipped in bulk
+				const char* stop = current + std::min<std::ptrdiff_t>(last - current, 16);
+				for (; current != stop and isSpace(*current); current++) {
+					if (*current == '\n') startLine(current + 1);
+				}
+				if (current == stop and current != last) {
+					const char* end = findSpace<false>(current, last);
+					for (; (current = std::find(current, end, '\n')) != end; current++) startLine(current + 1);
+				}
+				if (current != last or !refill()) return;
+			}
+		}
+
+		// the view is only valid until the next read
+		// scanning stops after maxLength + 1 chars, i.e., a longer view means that the token was cut
+		std::string_view token(std::size_t maxLength) {
+			UInteger begin = tell();
+			std::size_t length = 0;
+			while (true) {
+				std::size_t available = static_cast<std::size_t>(last - current);
+				const char* end = current + (available > maxLength ? maxLength + 1 : available);
+				length = static_cast<std::size_t>(findSpace<true>(current + length, end) - current);
+				if (length != available or !refill()) break;
+			}
+			std::string_view res(current, length);
+			current += length;
+			mark(begin);
+			return res;
+		}
+
+		// consumes the next count chars, they must be buffered and must not contain a newline
+		std::string_view take(std::size_t count) {
+			UInteger begin = tell();
+			std::string_view res(current, count);
+			current += count;
+			mark(begin);
+			return res;
+		}
+
+		// the next whitespace chars, the view is only valid until the next read
+		std::string_view spaces() {
+			UInteger begin = tell();
+			std::size_t length = 0;
+			while (true) {
+				length = static_cast<std::size_t>(findSpace<false>(current + length, last) - current);
+				if (current + length != last or !refill()) break;
+			}
+			std::string_view res(current, length);
+			Mark spaceMark = {line, lineStart, begin, begin + length};
+			skip(length);
+			lastMark = spaceMark;
+			return res;
+		}
+
+		// the view over the next chars has at least minimum chars unless the input ends before
+		std::string_view buffered(std::size_t minimum) {
+			while (static_cast<std::size_t>(last - current) < minimum and refill()) {}
+			return std::string_view(current, static_cast<std::size_t>(last - current));
+		}
+
+		// true if nothing more can be read
+		bool complete() const {
+			return done;
+		}
+
+		// the whole input, if it is memory mapped
+		std::optional<std::string_view> content() const {
+			return source->mapped();
+		}
+
+		// skips count chars that are already buffered
+		void skip(std::size_t count) {
+			const char* end = current + count;
+			while (current != end) {
+				const void* newline = std::memchr(current, '\n', static_cast<std::size_t>(end - current));
+				if (newline == nullptr) break;
+				current = static_cast<const char*>(newline) + 1;
+				startLine(current);
+			}
+			current = end;
+		}
+
+		UInteger tell() const {
+			return offset + static_cast<UInteger>(current - first);
+		}
+
+		const Mark& lastRead() const {
+			return lastMark;
+		}
+
+		void restoreMark(const Mark& mark) {
+			lastMark = mark;
+		}
+
+		// restricts the last mark to a single char of the last token
+		void markChar(std::size_t pos) {
+			lastMark.begin += pos;
+			lastMark.end = lastMark.begin + 1;
+		}
+
+		// the input in [from, tell()) that is still in memory
+		std::string_view history(UInteger from) const {
+			std::size_t skip = static_cast<std::size_t>(std::max(from, offset) - offset);
+			return std::string_view(first + skip, static_cast<std::size_t>(current - first) - skip);
+		}
+	};
+
+	// a fast non cryptographic hash, only used to detect changed files
+	UInteger hashBytes(std::string_view data, UInteger seed = 0) {
+		constexpr UInteger MULTIPLIER = 0x9E3779B97F4A7C15ull;
+		auto mix = [](UInteger h, UInteger word){
+			h = (h ^ word) * MULTIPLIER;
+			return h ^ (h >> 32);
+		};
+		// four independent lanes hide the latency of the multiplication
+		std::array<UInteger, 4> lanes = {seed, seed + 1, seed + 2, seed + 3};
+		std::size_t pos = 0;
+		for (; pos + 32 <= data.size(); pos += 32) {
+			for (std::size_t i = 0; i < 4; i++) {
+				UInteger word = 0;
+				std::memcpy(&word, data.data() + pos + 8 * i, 8);
+				lanes[i] = mix(lanes[i], word);
+			}
+		}
+		UInteger res = mix(data.size(), 0);
+		for (UInteger lane : lanes) res = mix(res, lane);
+		for (; pos < data.size(); pos += 8) {
+			UInteger word = 0;
+			std::memcpy(&word, data.data() + pos, std::min<std::size_t>(8, data.size() - pos));
+			res = mix(res, word);
+		}
+		// splitmix64 finalizer
+		res = (res ^ (res >> 30)) * 0xBF58476D1CE4E5B9ull;
+		res = (res ^ (res >> 27)) * 0x94D049BB133111EBull;
+		return res ^ (res >> 31);
+	}
+
+	// writes a temporary file first, so that concurrent readers never see a partial file
+	// errors are ignored since the file is only a cache
+	void replaceFile(const std::filesystem::path& file, std::initializer_list<std::string_view> parts) {
+		std::filesystem::path tmp = file;
+		tmp += ".tmp" + std::to_string(std::random_device()());
+		std::ofstream out(tmp, std::ios::binary);
+		for (std::string_view part : parts) out.write(part.data(), static_cast<std::streamsize>(part.size()));
+		out.close();
+		std::error_code error;
+		if (out) std::filesystem::rename(tmp, file, error);
+		if (!out or error) std::filesystem::remove(tmp, error);
+	}
+
+	// the whole content of a file, if it can be read
+	std::optional<std::string> readFile(const std::filesystem::path& file) {
+		std::ifstream in(file, std::ios::binary);
+		if (!in) return std::nullopt;
+		std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+		if (in.bad()) return std::nullopt;
+		return content;
+	}
+
+	// the path of the running binary, if it can be determined
+	// with STREAM_FALLBACK there is no memory mapped input, so nothing needs this
+	std::optional<std::filesystem::path> executablePath() {
+	#if defined(STREAM_FALLBACK)
+		return std::nullopt;
+	#elif defined(__APPLE__)
+		std::uint32_t size = 0;
+		::_NSGetExecutablePath(nullptr, &size);
+		std::string path(size, '\0');
+		if (::_NSGetExecutablePath(path.data(), &size) != 0) return std::nullopt;
+		path.resize(std::strlen(path.c_str()));
+		return path;
+	#else
+		std::error_code error;
+		if (!std::filesystem::exists("/proc/self/exe", error)) return std::nullopt;
+		return "/proc/self/exe";
+	#endif
+	}
+
+	// a hash of the running binary, if it can be read
+	// the binary is hashed in chunks and only once per process
+	std::optional<UInteger> binaryHash() {
+		static const std::optional<UInteger> hash = []() -> std::optional<UInteger> {
+			auto path = executablePath();
+			if (!path) return std::nullopt;
+			std::ifstream in(*path, std::ios::binary);
+			if (!in) return std::nullopt;
+			std::vector<char> chunk(1 << 20);
+			UInteger res = 0;
+			while (in) {
+				in.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+				res = hashBytes(std::string_view(chunk.data(), static_cast<std::size_t>(in.gcount())), res);
+			}
+			if (in.bad()) return std::nullopt;
+			return res;
+		}();
+		return hash;
+	}
+
+	// the parsed tokens of a memory mapped file, stored in a sidecar file
+	// the sidecar is keyed by the content of the file and the running binary,
+	// so that a stale or foreign cache is never used
+	class TokenCache final {
+	public:
+		static constexpr UInteger INTEGER = 1;
+		static constexpr UInteger REAL = 2;
+
+		// integers that are also valid reals are only stored as integer
+		struct Entry {
+			UInteger begin;
+			std::uint32_t length;
+			std::uint32_t flags;
+			union {
+				Integer integer;
+				Real real;
+			};
+
+			Real asReal() const {
+				return (flags & INTEGER) ? static_cast<Real>(integer) : real;
+			}
+		};
+
+	private:
+		struct Header {
+			std::array<char, 8> magic;
+			UInteger key, size, count;
+			UInteger checksum;	// of the entries, so that modified values are never trusted
+			UInteger padding;	// keeps the mapped entries aligned
+		};
+		static_assert(sizeof(Header) % alignof(Entry) == 0);
+		static constexpr std::array<char, 8> MAGIC = {'V', 'T', 'O', 'K', 'E', 'N', '3', static_cast<char>(sizeof(Real))};
+
+		static UInteger checksum(const Entry* first, std::size_t count, UInteger key) {
+			return hashBytes(std::string_view(reinterpret_cast<const char*>(first), count * sizeof(Entry)), key);
+		}
+
+		std::unique_ptr<ByteSource> source;	// keeps the sidecar mapped
+		std::vector<Entry> storage;
+		const Entry* last;
+		const Entry* next;
+
+		TokenCache(std::unique_ptr<ByteSource> source_, const Entry* first, const Entry* last_) :
+		           source(std::move(source_)), last(last_), next(first) {}
+		explicit TokenCache(std::vector<Entry> storage_) : storage(std::move(storage_)),
+		                                                   last(storage.data() + storage.size()), next(storage.data()) {}
+
+		static std::unique_ptr<TokenCache> read(const std::filesystem::path& file, UInteger key, std::size_t size) {
+			std::error_code error;
+			if (!std::filesystem::is_regular_file(file, error)) return nullptr;
+			std::unique_ptr<ByteSource> source;
+			try {
+				source = openSource(file);
+			} catch (const std::runtime_error&) {
+				return nullptr;
+			}
+			auto bytes = source->mapped();
+			if (!bytes or bytes->size() < sizeof(Header)) return nullptr;
+			Header header = {};
+			std::memcpy(&header, bytes->data(), sizeof(Header));
+			std::size_t length = bytes->size() - sizeof(Header);
+			if (header.magic != MAGIC or header.key != key or header.size != size) return nullptr;
+			if (length % sizeof(Entry) != 0 or length / sizeof(Entry) != header.count) return nullptr;
+			const Entry* first = reinterpret_cast<const Entry*>(bytes->data() + sizeof(Header));
+			const Entry* last = first + header.count;
+			if (header.checksum != checksum(first, header.count, key)) return nullptr;
+			// the entries must describe disjoint tokens of the file in order
+			UInteger pos = 0;
+			for (const Entry* it = first; it != last; it++) {
+				if (it->begin < pos or it->begin > size or it->length == 0 or it->length > size - it->begin) return nullptr;
+				if ((it->flags & ~(INTEGER | REAL)) != 0) return nullptr;
+				pos = it->begin + it->length + 1;
+			}
+			return std::unique_ptr<TokenCache>(new TokenCache(std::move(source), first, last));
+		}
+
+		static std::vector<Entry> parse(std::string_view content) {
+			std::vector<Entry> res;
+			const char* end = content.data() + content.size();
+			for (const char* it = findSpace<false>(content.data(), end); it != end; it = findSpace<false>(it, end)) {
+				const char* tokenEnd = findSpace<true>(it, end);
+				std::string_view token(it, static_cast<std::size_t>(tokenEnd - it));
+				it = tokenEnd;
+				if (token.size() > std::numeric_limits<std::uint32_t>::max()) continue;
+				// the entry is written to the sidecar as is, so unused bytes of the union must be zero
+				Entry entry;
+				std::memset(&entry, 0, sizeof(entry));
+				entry.begin = static_cast<UInteger>(token.data() - content.data());
+				entry.length = static_cast<std::uint32_t>(token.size());
+				Integer integer = 0;
+				Real real = 0;
+				bool isInteger = parseInteger(token, integer) == TokenResult::VALID;
+				bool isReal = parseReal(token, real) == TokenResult::VALID;
+				if (isInteger) {
+					entry.flags |= INTEGER;
+					entry.integer = integer;
+					if (isReal and static_cast<Real>(integer) == real) entry.flags |= REAL;
+				} else if (isReal) {
+					entry.flags |= REAL;
+					entry.real = real;
+				}
+				res.push_back(entry);
+			}
+			return res;
+		}
+
+		static void write(const std::filesystem::path& file, UInteger key, std::size_t size, const std::vector<Entry>& entries) {
+			Header header = {MAGIC, key, size, entries.size(), checksum(entries.data(), entries.size(), key), 0};
+			replaceFile(file, {
+				std::string_view(reinterpret_cast<const char*>(&header), sizeof(Header)),
+				std::string_view(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(Entry)),
+			});
+		}
+
+	public:
+		TokenCache(const TokenCache&) = delete;
+		TokenCache& operator=(const TokenCache&) = delete;
+
+		// loads or creates the cache for content in directory, returns nullptr if no cache can be used
+		static std::unique_ptr<TokenCache> open(const std::filesystem::path& directory, std::string_view content) {
+			auto binary = binaryHash();
+			if (!binary) return nullptr;
+			UInteger key = hashBytes(content, *binary);
+			std::ostringstream name;
+			name << std::hex << std::setw(16) << std::setfill('0') << key << ".tokens";
+			std::filesystem::path file = directory / name.str();
+			if (auto res = read(file, key, content.size())) return res;
+			std::vector<Entry> entries = parse(content);
+			write(file, key, content.size(), entries);
+			return std::unique_ptr<TokenCache>(new TokenCache(std::move(entries)));
+		}
+
+		// parses content without storing the cache
+		static std::unique_ptr<TokenCache> open(std::string_view content) {
+			return std::unique_ptr<TokenCache>(new TokenCache(parse(content)));
+		}
+
+		// the token starting at pos, positions must be queried in non decreasing order
+		const Entry* find(UInteger pos) {
+			if (next != last and next->begin < pos) {
+				next++;
+				if (next != last and next->begin < pos) {
+					next = std::lower_bound(next, last, pos, [](const Entry& entry, UInteger p){
+						return entry.begin < p;
+					});
+				}
+			}
+			if (next == last or next->begin != pos) return nullptr;
+			return next;
+		}
+	};
+}
+
+//============================================================================//
+// token patterns                                                             //
+//============================================================================//
+namespace details {
+	// parses a subset of ECMAScript regex: literals, escapes, ., [classes], (groups), |, *, +, ?, {n}, {n,}, {n,m}
+	// and compiles it to an NFA
+	class PatternCompiler final {
+		static constexpr std::size_t MAX_STATES = 1 << 16;
+		static constexpr Integer MAX_REPEAT = 1000;
+
+	public:
+		struct State {
+			std::bitset<256> chars;		// the chars that lead to next
+			std::size_t next = 0;
+			std::vector<std::size_t> epsilon;
+		};
+
+	private:
+		struct Node {
+			enum Kind {CHARS, CONCAT, ALTERNATE, REPEAT} kind;
+			std::bitset<256> chars;
+			std::vector<std::size_t> children;
+			Integer min, max;	// max < 0 is unbounded
+		};
+
+		std::string_view pattern;
+		bool caseSensitive;
+		std::size_t pos;
+		std::vector<Node> nodes;
+
+		void expect(bool valid, std::string_view message) const {
+			judgeAssert<std::invalid_argument>(valid, "TokenPattern: " + std::string(message) + " in \"" + std::string(pattern) + "\"!");
+		}
+
+		bool peek(char c) const {
+			return pos < pattern.size() and pattern[pos] == c;
+		}
+
+		std::size_t add(Node node) {
+			nodes.push_back(std::move(node));
+			return nodes.size() - 1;
+		}
+
+		std::bitset<256> fold(std::bitset<256> chars) const {
+			if (caseSensitive) return chars;
+			for (char c = 'a'; c <= 'z'; c++) {
+				std::size_t lower = static_cast<unsigned char>(c);
+				std::size_t upper = static_cast<unsigned char>(toUpper(c));
+				if (chars[lower] or chars[upper]) chars.set(lower).set(upper);
+			}
+			return chars;
+		}
+
+		static std::bitset<256> range(char from, char to) {
+			std::bitset<256> res;
+			for (int c = static_cast<unsigned char>(from); c <= static_cast<unsigned char>(to); c++) res.set(static_cast<std::size_t>(c));
+			return res;
+		}
+
+		static std::bitset<256> single(char c) {
+			return range(c, c);
+		}
+
+		// the chars of an escape sequence, the backslash is already consumed
+		std::bitset<256> escape() {
+			expect(pos < pattern.size(), "trailing backslash");
+			char c = pattern[pos++];
+			std::bitset<256> word = range('a', 'z') | range('A', 'Z') | range('0', '9') | single('_');
+			std::bitset<256> space = single(' ') | range('\t', '\r');
+			switch (c) {
+				case 'd': return range('0', '9');
+				case 'D': return ~range('0', '9');
+				case 'w': return word;
+				case 'W': return ~word;
+				case 's': return space;
+				case 'S': return ~space;
+				case 'n': return single('\n');
+				case 't': return single('\t');
+				case 'r': return single('\r');
+				case 'f': return single('\f');
+				case 'v': return single('\v');
+				default:
+					expect(!isLetter(c) and !isDigit(c), "unsupported escape \\" + std::string(1, c));
+					return single(c);
+			}
+		}
+
+		// a char inside of a class, the result is a single char unless it is an escape like \d
+		std::bitset<256> classChar() {
+			expect(pos < pattern.size(), "missing ]");
+			char c = pattern[pos++];
+			if (c == '\\') return escape();
+			return single(c);
+		}
+
+		// the opening bracket is already consumed
+		std::bitset<256> charClass() {
+			bool negate = peek('^');
+			if (negate) pos++;
+			std::bitset<256> res;
+			while (true) {
+				expect(pos < pattern.size(), "missing ]");
+				if (peek(']')) break;
+				std::bitset<256> from = classChar();
+				if (peek('-') and pos + 1 < pattern.size() and pattern[pos + 1] != ']') {
+					pos++;
+					std::bitset<256> to = classChar();
+					expect(from.count() == 1 and to.count() == 1, "invalid range");
+					std::size_t lower = 0, upper = 0;
+					while (!from[lower]) lower++;
+					while (!to[upper]) upper++;
+					expect(lower <= upper, "invalid range");
+					for (std::size_t c = lower; c <= upper; c++) res.set(c);
+				} else {
+					res |= from;
+				}
+			}
+			pos++;
+			// case folding must happen before the negation
+			res = fold(res);
+			return negate ? ~res : res;
+		}
+
+		Integer number() {
+			expect(pos < pattern.size() and isDigit(pattern[pos]), "expected a number");
+			Integer res = 0;
+			while (pos < pattern.size() and isDigit(pattern[pos])) {
+				res = res * 10 + (pattern[pos++] - '0');
+				expect(res <= MAX_REPEAT, "repetition is too large");
+			}
+			return res;
+		}
+
+		std::size_t atom() {
+			char c = pattern[pos++];
+			switch (c) {
+				case '(': {
+					if (pattern.substr(pos, 2) == "?:") pos += 2;
+					expect(!peek('?'), "lookarounds are not supported");
+					std::size_t res = alternation();
+					expect(peek(')'), "missing )");
+					pos++;
+					return res;
+				}
+				case '[': return add({Node::CHARS, charClass(), {}, 0, 0});
+				case '.': return add({Node::CHARS, ~(single('\n') | single('\r')), {}, 0, 0});
+				case '\\': return add({Node::CHARS, fold(escape()), {}, 0, 0});
+				case '^':
+				case '$':
+					expect(false, "anchors are not supported");
+					break;
+				case '*':
+				case '+':
+				case '?':
+				case '{':
+					expect(false, "nothing to repeat");
+					break;
+			}
+			return add({Node::CHARS, fold(single(c)), {}, 0, 0});
+		}
+
+		std::size_t repetition() {
+			std::size_t res = atom();
+			while (pos < pattern.size()) {
+				Integer min = 0, max = -1;
+				if (peek('*')) {
+					pos++;
+				} else if (peek('+')) {
+					pos++;
+					min = 1;
+				} else if (peek('?')) {
+					pos++;
+					max = 1;
+				} else if (peek('{')) {
+					pos++;
+					min = max = number();
+					if (peek(',')) {
+						pos++;
+						max = peek('}') ? -1 : number();
+					}
+					expect(peek('}'), "missing }");
+					pos++;
+					expect(max < 0 or min <= max, "invalid repetition");
+				} else {
+					break;
+				}
+				// lazy quantifiers match the same tokens
+				if (peek('?')) pos++;
+				res = add({Node::REPEAT, {}, {res}, min, max});
+			}
+			return res;
+		}
+
+		std::size_t concatenation() {
+			std::vector<std::size_t> parts;
+			while (pos < pattern.size() and !peek('|') and !peek(')')) parts.push_back(repetition());
+			return add({Node::CONCAT, {}, parts, 0, 0});
+		}
+
+		std::size_t alternation() {
+			std::vector<std::size_t> options = {concatenation()};
+			while (peek('|')) {
+				pos++;
+				options.push_back(concatenation());
+			}
+			if (options.size() == 1) return options[0];
+			return add({Node::ALTERNATE, {}, options, 0, 0});
+		}
+
+		std::size_t newState() {
+			expect(states.size() < MAX_STATES, "pattern is too large");
+			states.emplace_back();
+			return states.size() - 1;
+		}
+
+		// Thompson construction, returns the first and last state of the fragment
+		std::pair<std::size_t, std::size_t> build(std::size_t id) {
+			const Node& node = nodes[id];
+			std::size_t begin = newState();
+			std::size_t end = begin;
+			if (node.kind == Node::CHARS) {
+				end = newState();
+				states[begin].chars = node.chars;
+				states[begin].next = end;
+			} else if (node.kind == Node::CONCAT) {
+				for (std::size_t child : nodes[id].children) {
+					auto [first, last] = build(child);
+					states[end].epsilon.push_back(first);
+					end = last;
+				}
+			} else if (node.kind == Node::ALTERNATE) {
+				end = newState();
+				for (std::size_t child : nodes[id].children) {
+					auto [first, last] = build(child);
+					states[begin].epsilon.push_back(first);
+					states[last].epsilon.push_back(end);
+				}
+			} else {
+				Integer min = nodes[id].min;
+				Integer max = nodes[id].max;
+				std::size_t child = nodes[id].children[0];
+				for (Integer i = 0; i < min; i++) {
+					auto [first, last] = build(child);
+					states[end].epsilon.push_back(first);
+					end = last;
+				}
+				std::size_t exit = newState();
+				if (max < 0) {
+					auto [first, last] = build(child);
+					states[end].epsilon.push_back(first);
+					states[last].epsilon.push_back(first);
+					states[last].epsilon.push_back(exit);
+				} else {
+					for (Integer i = min; i < max; i++) {
+						auto [first, last] = build(child);
+						states[end].epsilon.push_back(first);
+						states[end].epsilon.push_back(exit);
+						end = last;
+					}
+				}
+				states[end].epsilon.push_back(exit);
+				end = exit;
+			}
+			return {begin, end};
+		}
+
+	public:
+		std::vector<State> states;
+		std::size_t start, accept;
+
+		PatternCompiler(std::string_view pattern_, bool caseSensitive_) : pattern(pattern_), caseSensitive(caseSensitive_), pos(0) {
+			std::size_t root = alternation();
+			expect(pos == pattern.size(), "unmatched )");
+			std::tie(start, accept) = build(root);
+		}
+	};
+}
+
+// a regex subset that is compiled to a DFA, matching is linear in the length of the token
+// supported are literals, escapes, ., [classes], (groups), |, *, +, ?, {n}, {n,}, {n,m}
+class TokenPattern final {
+	static constexpr std::size_t MAX_STATES = 1 << 14;
+
+	std::string source;
+	std::array<std::uint8_t, 256> classes;	// chars in the same class behave the same
+	std::size_t classCount;
+	std::vector<std::uint32_t> transitions;	// [state * classCount + class], state 0 rejects everything
+	std::vector<bool> accepting;
+
+public:
+	explicit TokenPattern(std::string_view pattern, bool caseSensitive = true) : source(pattern), classes(), classCount(0) {
+		details::PatternCompiler nfa(pattern, caseSensitive);
+		const auto& states = nfa.states;
+
+		std::map<std::vector<bool>, std::uint8_t> signatures;
+		std::vector<std::size_t> representatives;
+		for (std::size_t c = 0; c < 256; c++) {
+			std::vector<bool> signature(states.size());
+			for (std::size_t i = 0; i < states.size(); i++) signature[i] = states[i].chars[c];
+			auto [it, added] = signatures.try_emplace(std::move(signature), static_cast<std::uint8_t>(representatives.size()));
+			if (added) representatives.push_back(c);
+			classes[c] = it->second;
+		}
+		classCount = representatives.size();
+
+		// subset construction
+		std::vector<bool> seen(states.size());
+		auto closure = [&](std::vector<std::size_t> todo){
+			std::vector<std::size_t> res;
+			while (!todo.empty()) {
+				std::size_t state = todo.back();
+				todo.pop_back();
+				if (seen[state]) continue;
+				seen[state] = true;
+				res.push_back(state);
+				todo.insert(todo.end(), states[state].epsilon.begin(), states[state].epsilon.end());
+			}
+			for (std::size_t state : res) seen[state] = false;
+			std::sort(res.begin(), res.end());
+			return res;
+		};
+		std::map<std::vector<std::size_t>, std::uint32_t> ids;
+		std::vector<std::vector<std::size_t>> sets;
+		auto getId = [&](std::vector<std::size_t> set){
+			auto [it, added] = ids.try_emplace(set, static_cast<std::uint32_t>(sets.size()));
+			if (added) {
+				judgeAssert<std::invalid_argument>(sets.size() < MAX_STATES, "TokenPattern: pattern is too complex!");
+				sets.push_back(std::move(set));
+			}
+			return it->second;
+		};
+		getId({});
+		getId(closure({nfa.start}));
+		for (std::size_t id = 0; id < sets.size(); id++) {
+			accepting.push_back(std::binary_search(sets[id].begin(), sets[id].end(), nfa.accept));
+			for (std::size_t c : representatives) {
+				std::vector<std::size_t> next;
+				for (std::size_t state : sets[id]) {
+					if (states[state].chars[c]) next.push_back(states[state].next);
+				}
+				std::uint32_t target = getId(closure(std::move(next)));
+				transitions.push_back(target);
+			}
+		}
+	}
+
+	bool matches(std::string_view s) const {
+		std::uint32_t state = 1;
+		for (char c : s) {
+			state = transitions[state * classCount + classes[static_cast<unsigned char>(c)]];
+			if (state == 0) return false;
+		}
+		return accepting[state];
+	}
+
+	const std::string& str() const {
+		return source;
+	}
+};
+
+
+//============================================================================//
+// custom input stream                                                        //
+//============================================================================//
+namespace InputPolicy {
+	// the dimensions a policy can apply to
+	struct Space final {};
+	struct Case final {};
+
+	// whitespace/case sensitivity that is known at compile time
+	template<typename DIMENSION, bool VALUE>
+	struct Fixed final {
+		using Dimension = DIMENSION;
+		static constexpr bool isFixed = true;
+
+		constexpr Fixed() = default;
+		explicit Fixed(bool value) {
+			judgeAssert<std::invalid_argument>(value == VALUE, "InputPolicy: value does not match fixed policy!");
+		}
+		constexpr bool operator()() const {return VALUE;}
+	};
+
+	// whitespace/case sensitivity that is decided at runtime
+	struct Dynamic final {
+		using Dimension = void;
+		static constexpr bool isFixed = false;
+
+		bool value = false;
+		constexpr Dynamic() = default;
+		explicit constexpr Dynamic(bool value_) : value(value_) {}
+		constexpr bool operator()() const {return value;}
+	};
+
+	using SpaceSensitive = Fixed<Space, true>;
+	using SpaceInsensitive = Fixed<Space, false>;
+	using CaseSensitive = Fixed<Case, true>;
+	using CaseInsensitive = Fixed<Case, false>;
+}
+
+template<typename SpacePolicy, typename CasePolicy>
+class BasicInputStream final {
+	static_assert(std::is_same_v<typename SpacePolicy::Dimension, InputPolicy::Space> or !SpacePolicy::isFixed,
+	              "BasicInputStream: the first policy must be InputPolicy::SpaceSensitive, InputPolicy::SpaceInsensitive or InputPolicy::Dynamic!");
+	static_assert(std::is_same_v<typename CasePolicy::Dimension, InputPolicy::Case> or !CasePolicy::isFixed,
+	              "BasicInputStream: the second policy must be InputPolicy::CaseSensitive, InputPolicy::CaseInsensitive or InputPolicy::Dynamic!");
+	static constexpr bool FIXED = SpacePolicy::isFixed and CasePolicy::isFixed;
+
+	std::unique_ptr<details::InputBuffer> in;
+	SpacePolicy spaceSensitive;
+	CasePolicy caseSensitive;
+	OutputStream* out;
+	Verdicts::Verdict onFail;
+	Real floatAbsTol;
+	Real floatRelTol;
+	std::string caseBuffer;
+	std::size_t maxTokenLength;
+	std::unique_ptr<details::TokenCache> cache;
+	const details::TokenCache::Entry* cached;	// the cache entry of the last token
+
+	void checkIn() {
+		judgeAssert<std::runtime_error>(in != nullptr, "InputStream: not initialized!");
+	}
+
+public:
+	BasicInputStream() : maxTokenLength(std::numeric_limits<std::size_t>::max()), cached(nullptr) {}
+	explicit BasicInputStream(const std::filesystem::path& path,
+	                          bool spaceSensitive_,
+	                          bool caseSensitive_,
+	                          OutputStream& out_,
+	                          Verdicts::Verdict onFail_,
+	                          Real floatAbsTol_ = DEFAULT_EPS,
+	                          Real floatRelTol_ = DEFAULT_EPS) :
+	                          in(std::make_unique<details::InputBuffer>(details::openSource(path))),
+	                          spaceSensitive(spaceSensitive_),
+	                          caseSensitive(caseSensitive_),
+	                          out(&out_),
+	                          onFail(onFail_),
+	                          floatAbsTol(floatAbsTol_),
+	                          floatRelTol(floatRelTol_),
+	                          maxTokenLength(std::numeric_limits<std::size_t>::max()),
+	                          cached(nullptr) {
+		static_assert(!FIXED, "BasicInputStream: fixed policies do not take flags!");
+	}
+	explicit BasicInputStream(std::istream& in_,
+	                          bool spaceSensitive_,
+	                          bool caseSensitive_,
+	                          OutputStream& out_,
+	                          Verdicts::Verdict onFail_,
+	                          Real floatAbsTol_ = DEFAULT_EPS,
+	                          Real floatRelTol_ = DEFAULT_EPS) :
+	                          in(std::make_unique<details::InputBuffer>(details::openSource(in_))),
+	                          spaceSensitive(spaceSensitive_),
+	                          caseSensitive(caseSensitive_),
+	                          out(&out_),
+	                          onFail(onFail_),
+	                          floatAbsTol(floatAbsTol_),
+	                          floatRelTol(floatRelTol_),
+	                          maxTokenLength(std::numeric_limits<std::size_t>::max()),
+	                          cached(nullptr) {
+		static_assert(!FIXED, "BasicInputStream: fixed policies do not take flags!");
+	}
+	// with fixed policies the flags are taken from the policies
+	explicit BasicInputStream(const std::filesystem::path& path,
+	                          OutputStream& out_,
+	                          Verdicts::Verdict onFail_,
+	                          Real floatAbsTol_ = DEFAULT_EPS,
+	                          Real floatRelTol_ = DEFAULT_EPS) :
+	                          in(std::make_unique<details::InputBuffer>(details::openSource(path))),
+	                          out(&out_),
+	                          onFail(onFail_),
+	                          floatAbsTol(floatAbsTol_),
+	                          floatRelTol(floatRelTol_),
+	                          maxTokenLength(std::numeric_limits<std::size_t>::max()),
+	                          cached(nullptr) {
+		static_assert(FIXED, "BasicInputStream: dynamic policies need flags!");
+	}
+	explicit BasicInputStream(std::istream& in_,
+	                          OutputStream& out_,
+	                          Verdicts::Verdict onFail_,
+	                          Real floatAbsTol_ = DEFAULT_EPS,
+	                          Real floatRelTol_ = DEFAULT_EPS) :
+	                          in(std::make_unique<details::InputBuffer>(details::openSource(in_))),
+	                          out(&out_),
+	                          onFail(onFail_),
+	                          floatAbsTol(floatAbsTol_),
+	                          floatRelTol(floatRelTol_),
+	                          maxTokenLength(std::numeric_limits<std::size_t>::max()),
+	                          cached(nullptr) {
+		static_assert(FIXED, "BasicInputStream: dynamic policies need flags!");
+	}
+
+	BasicInputStream(BasicInputStream&& other) = default;
+	BasicInputStream& operator=(BasicInputStream&& other) = default;
+
+	BasicInputStream(const BasicInputStream&) = delete;
+	BasicInputStream& operator=(const BasicInputStream&) = delete;
+
+	void eof() {
+		checkIn();
+		if (!spaceSensitive()) in->skipSpace();
+		if (in->peek() != std::char_traits<char>::eof()) {
+			in->get();
+			*out << "Missing EOF!";
+			fail();
+		}
+	}
+
+	void noteof() {
+		checkIn();
+		if (!spaceSensitive()) in->skipSpace();
+		if (in->peek() == std::char_traits<char>::eof()) {
+			*out << "Unexpected EOF!" << onFail;
+		}
+	}
+
+	void space() {
+		if (spaceSensitive()) {
+			checkIn();
+			if (!in->consume(SPACE)) {
+				noteof();
+				in->get();
+				*out << "Missing space!";
+				fail();
+			}
+		}
+	}
+
+	void newline() {
+		if (spaceSensitive()) {
+			checkIn();
+			if (!in->consume(NEWLINE)) {
+				noteof();
+				in->get();
+				*out << "Missing newline!";
+				fail();
+			}
+		}
+	}
+
+private:
+	void check(std::string_view token, const std::regex& pattern) {
+		if (!std::regex_match(token.begin(), token.end(), pattern)) {
+			*out << "Token \"" << token << "\" does not match pattern!";
+			fail();
+		}
+	}
+
+	void check(std::string_view token, const TokenPattern& pattern) {
+		if (!pattern.matches(token)) {
+			*out << "Token \"" << token << "\" does not match pattern!";
+			fail();
+		}
+	}
+
+	template<char SEPARATOR, typename F>
+	void separated(std::size_t count, F& readElement) {
+		for (std::size_t i = 0; i < count; i++) {
+			readElement(i);
+			if (i + 1 < count) {
+				if constexpr (SEPARATOR == SPACE) space();
+				else newline();
+			}
+		}
+	}
+
+	// calls readElement(i) for each i in [0, count) and checks the separators in between
+	template<typename F>
+	void separated(std::size_t count, char separator, F&& readElement) {
+		if (separator == SPACE) return separated<SPACE>(count, readElement);
+		if (separator == NEWLINE) return separated<NEWLINE>(count, readElement);
+		judgeAssert<std::invalid_argument>(false, "InputStream: Separator must be ' '  or '\\n'!");
+	}
+
+	void check(std::string_view token, details::TokenResult result) {
+		if (result == details::TokenResult::MISMATCH) {
+			*out << "Token \"" << convertCase(token) << "\" does not match pattern!";
+			fail();
+		} else if (result == details::TokenResult::OUT_OF_RANGE) {
+			*out << "Could not parse token \"" << convertCase(token) << "\"!";
+			fail();
+		}
+	}
+
+	std::string getline() {
+		//using this is descouraged!
+		judgeAssert<std::invalid_argument>(spaceSensitive(), "InputStream: getline() must be used with case sensitive input!");
+		noteof();
+		std::string res;
+		int c = in->get();
+		for (; c != std::char_traits<char>::eof() and c != NEWLINE; c = in->get()) {
+			res += std::char_traits<char>::to_char_type(c);
+		}
+		if (c == std::char_traits<char>::eof()) noteof();
+		return res;
+	}
+
+	// the view is only valid until the next read
+	// at most limit + 1 chars are read, a longer token is cut
+	std::string_view token(std::size_t limit) {
+		noteof();
+		if (spaceSensitive() and !std::isgraph(in->peek())) {
+			in->get();
+			*out << "Invalid whitespace!";
+			fail();
+		}
+		limit = std::min(limit, maxTokenLength);
+		std::string_view res;
+		cached = cache ? cache->find(in->tell()) : nullptr;
+		std::size_t length = cached ? cached->length : 0;
+		if (cached and length <= limit and in->buffered(length).size() >= length) {
+			res = in->take(length);
+		} else {
+			cached = nullptr;
+			res = in->token(limit);
+		}
+		if (res.empty()) {
+			*out << "Unexpected EOF!" << onFail;
+		}
+		if (res.size() > maxTokenLength) {
+			*out << "Token is longer than " << maxTokenLength << " chars!";
+			fail();
+		}
+		return res;
+	}
+
+	std::string_view token() {
+		return token(maxTokenLength);
+	}
+
+	std::string_view caseToken(std::size_t limit) {
+		std::string_view res = token(limit);
+		if (caseSensitive()) return res;
+		caseBuffer.assign(res);
+		toDefaultCase(caseBuffer);
+		return caseBuffer;
+	}
+
+	std::string convertCase(std::string_view s) const {
+		std::string res(s);
+		if (!caseSensitive()) toDefaultCase(res);
+		return res;
+	}
+
+public:
+	// tokens longer than this are rejected before they are read completely
+	void limitTokenLength(Integer limit) {
+		judgeAssert<std::invalid_argument>(limit >= 0, "InputStream: token length limit must be non-negative!");
+		maxTokenLength = static_cast<std::size_t>(limit);
+	}
+
+	// reading more than bytes chars from this stream fails
+	void limitLength(Integer bytes) {
+		checkIn();
+		judgeAssert<std::invalid_argument>(bytes >= 0, "InputStream: length limit must be non-negative!");
+		in->limitLength(static_cast<UInteger>(bytes), [out = out, onFail = onFail, bytes](){
+			*out << "Input is longer than " << bytes << " bytes!" << onFail;
+		});
+	}
+
+	// waiting longer than milliseconds for more input fails, this only works for pipes and similar
+	void limitWaitTime(Integer milliseconds) {
+		checkIn();
+		judgeAssert<std::invalid_argument>(milliseconds >= 0, "InputStream: wait time limit must be non-negative!");
+		in->limitWaitTime(milliseconds, [out = out, onFail = onFail, milliseconds](){
+			*out << "No response within " << milliseconds << " ms, did you flush?" << onFail;
+		});
+	}
+
+	// os gets flushed whenever this stream has to wait for more input
+	void tie(OutputStream& os) {
+		checkIn();
+		in->tie(&os);
+	}
+
+	// reuses the parsed tokens of a previous run with the same input and binary
+	// the cache is stored in directory, nothing happens if the input is not a regular file
+	void useTokenCache(const std::filesystem::path& directory) {
+		checkIn();
+		auto content = in->content();
+		if (!content or in->tell() != 0) return;
+		cache = details::TokenCache::open(directory, *content);
+	}
+
+	// parses all tokens now and keeps them in memory
+	void useTokenCache() {
+		checkIn();
+		auto content = in->content();
+		if (!content or in->tell() != 0 or cache) return;
+		cache = details::TokenCache::open(*content);
+	}
+
+	// the view is only valid until the next read
+	std::string_view stringView() {
+		return caseToken(maxTokenLength);
+	}
+
+	std::string_view stringView(Integer lower, Integer upper) {
+		// upper also limits how much is read
+		std::string_view t = caseToken(static_cast<std::size_t>(std::max<Integer>(upper, 1) - 1));
+		Integer length = static_cast<Integer>(t.size());
+		if (length >= upper) {
+			*out << "String length >= " << upper << " out of range [" << lower << ", " << upper << ")!";
+			fail();
+		} else if (length < lower) {
+			*out << "String length " << length << " out of range [" << lower << ", " << upper << ")!";
+			fail();
+		}
+		return t;
+	}
+
+	std::string_view stringView(Integer lower, Integer upper, Constraint& constraint) {
+		std::string_view res = stringView(lower, upper);
+		constraint.log(lower, upper, res);
+		return res;
+	}
+
+	std::string_view stringView(const std::regex& pattern) {
+		std::string_view t = stringView();
+		check(t, pattern);
+		return t;
+	}
+
+	std::string_view stringView(const std::regex& pattern, Integer lower, Integer upper) {
+		std::string_view t = stringView(lower, upper);
+		check(t, pattern);
+		return t;
+	}
+
+	std::string_view stringView(const std::regex& pattern, Integer lower, Integer upper, Constraint& constraint) {
+		std::string_view res = stringView(pattern, lower, upper);
+		constraint.log(lower, upper, res);
+		return res;
+	}
+
+	std::string_view stringView(const TokenPattern& pattern) {
+		std::string_view t = stringView();
+		check(t, pattern);
+		return t;
+	}
+
+	std::string_view stringView(const TokenPattern& pattern, Integer lower, Integer upper) {
+		std::string_view t = stringView(lower, upper);
+		check(t, pattern);
+		return t;
+	}
+
+	std::string_view stringView(const TokenPattern& pattern, Integer lower, Integer upper, Constraint& constraint) {
+		std::string_view res = stringView(pattern, lower, upper);
+		constraint.log(lower, upper, res);
 		return res;
 	}
 
+	std::string string() {
+		return std::string(stringView());
+	}
+
+	std::string string(Integer lower, Integer upper) {
+		return std::string(stringView(lower, upper));
+	}
+
+	std::string string(Integer lower, Integer upper, Constraint& constraint) {
+		return std::string(stringView(lower, upper, constraint));
+	}
+
+	std::string string(const std::regex& pattern) {
+		return std::string(stringView(pattern));
+	}
+
+	std::string string(const std::regex& pattern, Integer lower, Integer upper) {
+		return std::string(stringView(pattern, lower, upper));
+	}
+
+	std::string string(const std::regex& pattern, Integer lower, Integer upper, Constraint& constraint) {
+		return std::string(stringView(pattern, lower, upper, constraint));
+	}
+
+	std::string string(const TokenPattern& pattern) {
+		return std::string(stringView(pattern));
+	}
+
+	std::string string(const TokenPattern& pattern, Integer lower, Integer upper) {
+		return std::string(stringView(pattern, lower, upper));
+	}
+
+	std::string string(const TokenPattern& pattern, Integer lower, Integer upper, Constraint& constraint) {
+		return std::string(stringView(pattern, lower, upper, constraint));
+	}
+
 	template<typename... Args>
 	std::vector<std::string> strings(Integer count, Args... args, char separator) {
-		auto sepCall = checkSeparator(separator);
 		std::vector<std::string> res(count);
-		for (std::size_t i = 0; i < res.size(); i++) {
+		separated(res.size(), separator, [&](std::size_t i){
 			res[i] = string(args...);
-			if (i + 1 < res.size()) sepCall();
-		}
+		});
 		return res;
 	}
 
@@ -2534,8 +4455,93 @@ public:
 		return strings<const std::regex&, Integer, Integer, Constraint&>(count, pattern, lower, upper, constraint, separator);
 	}
 
+	std::vector<std::string> strings(Integer count, const TokenPattern& pattern,
+	                                 char separator = DEFAULT_SEPARATOR) {
+		return strings<const TokenPattern&>(count, pattern, separator);
+	}
+
+	std::vector<std::string> strings(Integer count, const TokenPattern& pattern, Integer lower, Integer upper,
+	                                 char separator = DEFAULT_SEPARATOR) {
+		return strings<const TokenPattern&, Integer, Integer>(count, pattern, lower, upper, separator);
+	}
+
+	std::vector<std::string> strings(Integer count, const TokenPattern& pattern, Integer lower, Integer upper,
+	                                 Constraint& constraint, char separator = DEFAULT_SEPARATOR) {
+		return strings<const TokenPattern&, Integer, Integer, Constraint&>(count, pattern, lower, upper, constraint, separator);
+	}
+
+	Matrix<char> grid(Integer height, Integer width, std::string_view alphabet) {
+		judgeAssert<std::invalid_argument>(height >= 0 and width >= 0, "InputStream: grid dimensions must be non-negative!");
+		std::array<bool, 256> allowed = {};
+		for (char c : alphabet) {
+			if (!caseSensitive()) c = toDefaultCase(c);
+			allowed[static_cast<unsigned char>(c)] = true;
+		}
+		std::size_t w = static_cast<std::size_t>(width);
+		Matrix<char> res(static_cast<std::size_t>(height), w);
+		if (w == 0) {
+			// empty rows are no tokens, only the newlines between them are checked
+			separated(res.rows(), NEWLINE, [](std::size_t /**/){});
+			return res;
+		}
+		separated(res.rows(), NEWLINE, [&](std::size_t i){
+			std::string_view row = caseToken(w);
+			if (row.size() != w) {
+				*out << "Row " << i << " does not have length " << width << "!";
+				fail();
+			}
+			bool valid = true;
+			for (char c : row) valid &= allowed[static_cast<unsigned char>(c)];
+			if (!valid) {
+				std::size_t j = 0;
+				while (allowed[static_cast<unsigned char>(row[j])]) j++;
+				*out << "Character '" << row[j] << "' in row " << i << " is not in the alphabet!";
+				in->markChar(j);
+				fail();
+			}
+			std::copy(row.begin(), row.end(), res[i]);
+		});
+		return res;
+	}
+
+private:
+	template<typename... Args>
+	Matrix<Integer> readMatrix(Integer rows, Integer cols, Args... args) {
+		judgeAssert<std::invalid_argument>(rows >= 0 and cols >= 0, "InputStream: matrix dimensions must be non-negative!");
+		Matrix<Integer> res(static_cast<std::size_t>(rows), static_cast<std::size_t>(cols));
+		separated(res.rows(), NEWLINE, [&](std::size_t i){
+			Integer* row = res[i];
+			separated(res.cols(), SPACE, [&](std::size_t j){
+				row[j] = integer(args...);
+			});
+		});
+		return res;
+	}
+
+public:
+	Matrix<Integer> matrix(Integer rows, Integer cols) {
+		return readMatrix(rows, cols);
+	}
+
+	Matrix<Integer> matrix(Integer rows, Integer cols, Integer lower, Integer upper) {
+		return readMatrix(rows, cols, lower, upper);
+	}
+
+	Matrix<Integer> matrix(Integer rows, Integer cols, Integer lower, Integer upper, Constraint& constraint) {
+		Matrix<Integer> res = matrix(rows, cols, lower, upper);
+		if (res.size() > 0) {
+			auto [min, max] = std::minmax_element(res.begin(), res.end());
+			constraint.log(lower, upper, *min);
+			constraint.log(lower, upper, *max);
+		}
+		return res;
+	}
+
 	Integer integer() {
-		return parse<Integer>(string(INTEGER_REGEX));
+		std::string_view t = token();
+		Integer res = 0;
+		check(t, parseInteger(t, res));
+		return res;
 	}
 
 	Integer integer(Integer lower, Integer upper) {
@@ -2555,12 +4561,10 @@ public:
 
 	template<typename... Args>
 	std::vector<Integer> integers(Integer count, Args... args, char separator) {
-		auto sepCall = checkSeparator(separator);
 		std::vector<Integer> res(count);
-		for (std::size_t i = 0; i < res.size(); i++) {
+		separated(res.size(), separator, [&](std::size_t i){
 			res[i] = integer(args...);
-			if (i + 1 < res.size()) sepCall();
-		}
+		});
 		return res;
 	}
 
@@ -2581,7 +4585,10 @@ public:
 	// this does not allow NaN or Inf!
 	// However, those should never be desired.
 	Real real() {
-		return parse<Real>(string(REAL_REGEX));
+		std::string_view t = token();
+		Real res = 0;
+		check(t, parseReal(t, res));
+		return res;
 	}
 
 	Real real(Real lower, Real upper) {// uses eps
@@ -2603,12 +4610,10 @@ public:
 
 	template<typename... Args>
 	std::vector<Real> reals(Integer count, Args... args, char separator) {
-		auto sepCall = checkSeparator(separator);
 		std::vector<Real> res(count);
-		for (std::size_t i = 0; i < res.size(); i++) {
+		separated(res.size(), separator, [&](std::size_t i){
 			res[i] = real(args...);
-			if (i + 1 < res.size()) sepCall();
-		}
+		});
 		return res;
 	}
 
@@ -2627,26 +4632,22 @@ public:
 	}
 
 	Real realStrict(Real lower, Real upper, Integer minDecimals, Integer maxDecimals) {// does not use eps
-		std::string t = string(STRICT_REAL_REGEX);
-		auto dot = t.find('.');
-		Integer decimals = dot == std::string::npos ? 0 : t.size() - dot - 1;
+		std::string_view t = token();
+		Real res = 0;
+		Integer decimals = 0;
+		auto result = details::parseRealStrict(t, res, decimals);
+		if (result == details::TokenResult::MISMATCH) check(t, result);
 		if (decimals < minDecimals or decimals >= maxDecimals) {
 			*out << "Real " << t << " has wrong amount of decimals!";
 			fail();
 			return 0;
 		}
-		try {
-			Real res = parse<Real>(t);
-			if (std::isnan(res) or !(res >= lower) or !(res < upper)) {
-				*out << "Real " << res << " out of range [" << lower << ", " << upper << ")!";
-				fail();
-			}
-			return res;
-		} catch(...) {
-			*out << "Could not parse token \"" << t << "\" as real!";
+		check(t, result);
+		if (std::isnan(res) or !(res >= lower) or !(res < upper)) {
+			*out << "Real " << res << " out of range [" << lower << ", " << upper << ")!";
 			fail();
-			return 0;
 		}
+		return res;
 	}
 
 	Real realStrict(Real lower, Real upper, Integer minDecimals, Integer maxDecimals, Constraint& constraint) {
@@ -2657,12 +4658,10 @@ public:
 
 	template<typename... Args>
 	std::vector<Real> realsStrict(Integer count, Args... args, char separator) {
-		auto sepCall = checkSeparator(separator);
 		std::vector<Real> res(count);
-		for (std::size_t i = 0; i < res.size(); i++) {
+		separated(res.size(), separator, [&](std::size_t i){
 			res[i] = realStrict(args...);
-			if (i + 1 < res.size()) sepCall();
-		}
+		});
 		return res;
 	}
 
@@ -2678,8 +4677,12 @@ public:
 
 	void expectString(std::string_view expected) {
 		judgeAssert<std::invalid_argument>(details::isToken(expected), "InputStream: expected must not contain a space!");
-		std::string seen = string();
-		auto [eq, pos] = details::stringEqual(seen, expected, caseSensitive);
+		checkString(stringView(), expected);
+	}
+
+private:
+	void checkString(std::string_view seen, std::string_view expected) {
+		auto [eq, pos] = details::stringEqual(seen, expected, caseSensitive());
 		if (!eq) {
 			auto format = [pos=pos,out=out](std::string_view s){
 				Integer PREFIX = 10;
@@ -2706,6 +4709,7 @@ public:
 		}
 	}
 
+public:
 	void expectInt(Integer expected) {
 		Integer seen = integer();
 		if (seen != expected) {
@@ -2716,76 +4720,196 @@ public:
 
 	void expectReal(Real expected) {
 		Real seen = real();
-		if (details::floatEqual(seen, expected, floatAbsTol, floatRelTol)) {
+		if (!details::floatEqual(seen, expected, floatAbsTol, floatRelTol)) {
 			*out << "Expected " << expected << " but got " << seen << "!";
-			if (std::isfinite(seen) and std::isfinite(expected)) {
-				Real absDiff = std::abs(seen-expected);
-				Real relDiff = std::abs((seen-expected)/expected);
-				*out << " (abs: " << absDiff << ", rel: " << relDiff << ")";
-			}
+			printDiff(seen, expected);
 			fail();
 		}
 	}
-private:
-	void fail() {
-		//try to find input position...
-		in->clear();
-		auto originalPos = in->tellg();
-		in->seekg(0);
-		if (originalPos != std::streamoff(-1) and *in) {
-			Integer line = 1;
-			std::size_t l = 0, r = 0;
-			std::string buffer;
-			bool extend = true;
-			while (*in and in->tellg() < originalPos) {
-				l = r = buffer.size();
-				if (std::isgraph(in->peek())) {
-					std::string tmp;
-					*in >> tmp;
-					buffer += tmp;
-				} else if (in->peek() == std::char_traits<char>::to_int_type(NEWLINE)) {
-					line++;
-					in->get();
-					if (in->tellg() < originalPos) {
-						buffer.clear();
-					} else {
-						buffer += ' ';
-						extend = false;
-					}
-				} else {
-					buffer += std::char_traits<char>::to_char_type(in->get());
-				}
-				if (*in and in->tellg() >= originalPos) {
-					r = buffer.size();
+
+	template<typename RandomIt>
+	void expectReals(RandomIt first, RandomIt last, char separator = DEFAULT_SEPARATOR) {
+		judgeAssert<std::invalid_argument>(separator == SPACE or separator == NEWLINE, "InputStream: Separator must be ' '  or '\\n'!");
+		// values are compared in blocks, the marks allow to report the position of a mismatch
+		constexpr std::size_t BLOCK = 64;
+		std::array<Real, BLOCK> seen, expected;
+		std::array<details::InputBuffer::Mark, BLOCK> marks;
+		std::size_t count = static_cast<std::size_t>(std::distance(first, last));
+		// compares the first n values of the current block, which ends before index i
+		auto compare = [&](std::size_t i, std::size_t n){
+			std::size_t k = details::firstUnequal(seen.data(), expected.data(), n, floatAbsTol, floatRelTol);
+			if (k < n) {
+				in->restoreMark(marks[k]);
+				*out << "Expected " << expected[k] << " but got " << seen[k] << " at index " << i - n + k << "!";
+				printDiff(seen[k], expected[k]);
+				fail();
+			}
+		};
+		// a mismatch earlier in the block is reported before any error at index i
+		for (std::size_t i = 0; i < count; i++) {
+			std::size_t j = i % BLOCK;
+			if (i > 0) {
+				if (spaceSensitive()) {
+					checkIn();
+					if (in->peek() != std::char_traits<char>::to_int_type(separator)) compare(i, j);
 				}
+				if (separator == SPACE) space();
+				else newline();
 			}
-			if (l != r) {
-				*out << " Line: " << line << ", Char: " << l << '\n';
-				if (extend) {
-					char tmp;
-					while ((buffer.size() < 80 or buffer.size() < r + 80) and in->get(tmp) and tmp != NEWLINE) {
-						buffer += tmp;
-					}
+			expected[j] = static_cast<Real>(first[static_cast<typename std::iterator_traits<RandomIt>::difference_type>(i)]);
+			checkIn();
+			if (!spaceSensitive()) in->skipSpace();
+			int c = in->peek();
+			if (c == std::char_traits<char>::eof() or (spaceSensitive() and !std::isgraph(c))) compare(i, j);
+			std::string_view t = token();
+			details::TokenResult result = parseReal(t, seen[j]);
+			marks[j] = in->lastRead();
+			if (result != details::TokenResult::VALID) {
+				compare(i, j);
+				check(t, result);
+			}
+			if (j + 1 == BLOCK or i + 1 == count) compare(i + 1, j + 1);
+		}
+	}
+
+	void expectReals(const std::vector<Real>& expected, char separator = DEFAULT_SEPARATOR) {
+		expectReals(expected.begin(), expected.end(), separator);
+	}
+
+	// compares the rest of this stream with the rest of expected token by token
+	// tokens that are reals in expected are compared with tolerance, all others like expectString()
+	template<typename S, typename C>
+	void expectSame(BasicInputStream<S, C>& expected, Real floatAbsTol_, Real floatRelTol_) {
+		checkIn();
+		expected.checkIn();
+		details::InputBuffer& jury = *expected.in;
+		// skip the common prefix up to its last whitespace in bulk
+		while (true) {
+			std::string_view a = jury.buffered(COMPARE_SIZE);
+			std::string_view b = in->buffered(COMPARE_SIZE);
+			std::size_t same = details::commonPrefix(a, b);
+			std::size_t skip = same;
+			if (same != a.size() or same != b.size() or !jury.complete() or !in->complete()) {
+				while (skip > 0 and !details::isSpace(a[skip - 1])) skip--;
+			}
+			if (skip == 0) break;
+			jury.skip(skip);
+			in->skip(skip);
+		}
+		// compare the remaining tokens
+		while (true) {
+			if (spaceSensitive()) {
+				std::string_view seen = in->spaces();
+				if (seen != jury.spaces()) {
+					*out << "Wrong whitespace!";
+					fail();
 				}
-				if (r > 60 and l > 20) {
-					std::size_t offset = std::min(l - 20, r - 60);
-					l -= offset;
-					r -= offset;
-					buffer = std::string(TEXT_ELLIPSIS) + buffer.substr(offset + TEXT_ELLIPSIS.size());
+			} else {
+				jury.skipSpace();
+			}
+			if (jury.peek() == std::char_traits<char>::eof()) break;
+			std::string_view want = expected.token();
+			Real wantReal = 0;
+			bool isReal = expected.parseReal(want, wantReal) == details::TokenResult::VALID;
+			std::string_view seen = token();
+			if (isReal) {
+				Real seenReal = 0;
+				bool valid = details::parseReal(seen, seenReal) == details::TokenResult::VALID;
+				if (!valid or !details::floatEqual(seenReal, wantReal, floatAbsTol_, floatRelTol_)) {
+					*out << "Expected " << want << " but got " << seen << "!";
+					if (valid) printDiff(seenReal, wantReal);
+					fail();
 				}
-				if (buffer.size() > 80) {
-					buffer = buffer.substr(0, 80 - TEXT_ELLIPSIS.size());
-					buffer += TEXT_ELLIPSIS;
-					r = std::min(r, buffer.size());
+			} else {
+				checkString(seen, want);
+			}
+		}
+		eof();
+	}
+
+	template<typename S, typename C>
+	void expectSame(BasicInputStream<S, C>& expected) {
+		expectSame(expected, floatAbsTol, floatRelTol);
+	}
+
+private:
+	template<typename, typename>
+	friend class BasicInputStream;
+
+	static constexpr std::size_t COMPARE_SIZE = 1 << 16;
+
+	// parses the last token, the cache is used if it has an entry for it
+	details::TokenResult parseInteger(std::string_view t, Integer& res) const {
+		if (cached and (cached->flags & details::TokenCache::INTEGER)) {
+			res = cached->integer;
+			return details::TokenResult::VALID;
+		}
+		return details::parseInteger(t, res);
+	}
+
+	details::TokenResult parseReal(std::string_view t, Real& res) const {
+		if (cached and (cached->flags & details::TokenCache::REAL)) {
+			res = cached->asReal();
+			return details::TokenResult::VALID;
+		}
+		return details::parseReal(t, res);
+	}
+
+	void printDiff(Real seen, Real expected) {
+		if (std::isfinite(seen) and std::isfinite(expected)) {
+			Real absDiff = std::abs(seen-expected);
+			Real relDiff = std::abs((seen-expected)/expected);
+			*out << " (abs: " << absDiff << ", rel: " << relDiff << ")";
+		}
+	}
+
+	void fail() {
+		//print the input position...
+		const auto& mark = in->lastRead();
+		if (mark.end > mark.begin) {
+			*out << " Line: " << mark.line << ", Char: " << (mark.begin - mark.lineStart) << '\n';
+			// only the part of the line around the last token gets printed
+			UInteger begin = mark.begin - mark.lineStart;
+			UInteger end = std::min(std::max(mark.end - mark.lineStart, begin + 1), begin + 80);
+			UInteger shift = end > 60 and begin > 20 ? std::min(begin - 20, end - 60) : 0;
+			std::string_view history = in->history(mark.lineStart + shift);
+			UInteger skipped = in->tell() - mark.lineStart - history.size();
+			std::size_t l = static_cast<std::size_t>(std::max(begin, skipped) - skipped);
+			std::size_t r = static_cast<std::size_t>(std::max(end, skipped) - skipped);
+			r = std::max(r, l + 1);
+			std::string buffer(history.substr(0, r + 80));
+			bool extend = buffer.size() == history.size();
+			if (auto pos = buffer.find(NEWLINE, l); pos != std::string::npos) {
+				buffer.resize(pos);
+				if (pos < r) buffer += ' ';
+				extend = false;
+			}
+			if (extend) {
+				in->ignoreLimit();
+				int c = 0;
+				while ((buffer.size() < 80 or buffer.size() < r + 80) and
+				       (c = in->get()) != std::char_traits<char>::eof() and
+				       c != std::char_traits<char>::to_int_type(NEWLINE)) {
+					buffer += std::char_traits<char>::to_char_type(c);
 				}
-				*out << buffer << '\n';
-				*out << std::string(l, ' ') << '^' << std::string(r - l - 1, '~');
 			}
+			if (skipped > 0) {
+				buffer.replace(0, std::min(buffer.size(), TEXT_ELLIPSIS.size()), TEXT_ELLIPSIS);
+			}
+			if (buffer.size() > 80) {
+				buffer = buffer.substr(0, 80 - TEXT_ELLIPSIS.size());
+				buffer += TEXT_ELLIPSIS;
+				r = std::min(r, buffer.size());
+			}
+			*out << buffer << '\n';
+			*out << std::string(l, ' ') << '^' << std::string(r - l - 1, '~');
 		}
 		*out << onFail;
 	}
 };
 
+using InputStream = BasicInputStream<InputPolicy::Dynamic, InputPolicy::Dynamic>;
+
 
 //============================================================================//
 // state guard                                                                //
@@ -2854,6 +4978,10 @@ public:
 		if (!value) f |= std::regex_constants::icase;
 		return std::regex(s.data(), s.size(), f);
 	}
+
+	TokenPattern pattern(std::string_view s) const {
+		return TokenPattern(s, value);
+	}
 };
 
 
@@ -2869,6 +4997,9 @@ namespace ValidateBase {
 	Setting<Real> floatRelTol(DEFAULT_EPS);
 	Setting<bool> spaceSensitive(false);
 	SettingCaseSensitive caseSensitive(false);
+	Setting<Integer> maxTokenLength(DEFAULT_MAX_TOKEN_LENGTH);	// only applies to team output
+	Setting<Integer> outputLimit(std::numeric_limits<Integer>::max());	// total bytes of team output
+	Setting<Integer> responseTimeout(-1);	// ms an interactor waits for the team, negative means no limit
 
 	// Real r2 is considered the reference value for relative error.
 	bool floatEqual(Real given,
@@ -2914,9 +5045,22 @@ namespace ValidateBase {
 
 			if (arguments.getRaw(SPACE_SENSITIVE)) spaceSensitive = true;
 			if (arguments.getRaw(CASE_SENSITIVE)) caseSensitive = true;
+			outputLimit = arguments[OUTPUT_LIMIT_COMMAND].asInteger(outputLimit);
+			responseTimeout = arguments[RESPONSE_TIMEOUT_COMMAND].asInteger(responseTimeout);
 
 			::details::initialized(true);
 		}
+
+		// replaces the program arguments, e.g., in a forked child
+		void setArguments(std::vector<std::string> args) {
+			// the arguments must outlive the CommandParser
+			static std::vector<std::string> storage;
+			static std::vector<char*> pointers;
+			storage = std::move(args);
+			pointers.clear();
+			for (auto& arg : storage) pointers.push_back(arg.data());
+			arguments = CommandParser(static_cast<int>(pointers.size()), pointers.data());
+		}
 	}
 
 } // namespace ValidateBase
@@ -2940,11 +5084,244 @@ namespace InputValidator {
 
 	InputStream testIn;
 
+	namespace details {
+		// the files of a directory with extension .in or the lines of a file
+		std::vector<std::filesystem::path> batchFiles(const std::filesystem::path& source) {
+			std::vector<std::filesystem::path> res;
+			if (std::filesystem::is_directory(source)) {
+				for (const auto& entry : std::filesystem::directory_iterator(source)) {
+					if (entry.is_regular_file() and entry.path().extension() == ".in") res.push_back(entry.path());
+				}
+				std::sort(res.begin(), res.end());
+			} else {
+				std::ifstream list(source);
+				judgeAssert<std::runtime_error>(list.good(), "InputValidator: Could not open File: " + source.string());
+				for (std::string line; std::getline(list, line);) {
+					if (!line.empty()) res.emplace_back(line);
+				}
+			}
+			return res;
+		}
+
+		// validates each file in a forked child with at most jobs children at a time and never returns in this process,
+		// instead this function returns in each child with stdin set to its file and stdout captured for the report
+		void batch(int argc, char** argv, const std::filesystem::path& source, Integer jobs) {
+		#ifndef STREAM_FALLBACK
+			judgeAssert<std::invalid_argument>(jobs > 0, "InputValidator: jobs must be positive!");
+			std::vector<std::filesystem::path> files = batchFiles(source);
+			judgeAssert<std::invalid_argument>(!files.empty(), "InputValidator: No files to validate in: " + source.string());
+			std::vector<std::FILE*> outputs(files.size(), nullptr);
+			std::vector<std::string> messages(files.size());
+			std::vector<int> codes(files.size(), 0);
+			std::map<pid_t, std::size_t> running;
+			std::size_t next = 0;
+			while (next < files.size() or !running.empty()) {
+				if (next < files.size() and static_cast<Integer>(running.size()) < jobs) {
+					int fd = ::open(files[next].c_str(), O_RDONLY);
+					if (fd < 0) {
+						// reported like a failed run of this file
+						codes[next] = Verdicts::FAIL;
+						messages[next] = "InputValidator: Could not open File: " + files[next].string() + "\n";
+						next++;
+						continue;
+					}
+					outputs[next] = std::tmpfile();
+					judgeAssert<std::runtime_error>(outputs[next] != nullptr, "InputValidator: Could not create temporary file!");
+					ValidateBase::juryOut.flush();
+					std::cout.flush();
+					std::cerr.flush();
+					pid_t child = ::fork();
+					judgeAssert<std::runtime_error>(child >= 0, "InputValidator: Could not fork!");
+					if (child == 0) {
+						::dup2(::fileno(outputs[next]), STDOUT_FILENO);
+						::dup2(::fileno(outputs[next]), STDERR_FILENO);
+						::dup2(fd, STDIN_FILENO);
+						::close(fd);
+						// the outputs of the other running children must not stay open in this one
+						for (std::FILE* output : outputs) {
+							if (output != nullptr) std::fclose(output);
+						}
+						// each file gets its own constraints file
+						std::vector<std::string> args(argv, argv + argc);
+						for (std::size_t i = 0; i + 1 < args.size(); i++) {
+							if (args[i] == CONSTRAINT_COMMAND) args[i + 1] += "." + std::to_string(next);
+						}
+						ValidateBase::details::setArguments(std::move(args));
+						return;
+					}
+					::close(fd);
+					running.emplace(child, next);
+					next++;
+				} else {
+					int status = 0;
+					pid_t child = ::waitpid(-1, &status, 0);
+					auto it = running.find(child);
+					if (it == running.end()) continue;
+					std::size_t id = it->second;
+					running.erase(it);
+					codes[id] = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+					// only the files of running children stay open
+					std::rewind(outputs[id]);
+					std::array<char, 1 << 12> buffer;
+					for (std::size_t read; (read = std::fread(buffer.data(), 1, buffer.size(), outputs[id])) > 0;) {
+						messages[id].append(buffer.data(), read);
+					}
+					std::fclose(outputs[id]);
+					outputs[id] = nullptr;
+				}
+			}
+			// the report lists the files in order, each followed by its messages
+			int res = Verdicts::AC;
+			for (std::size_t i = 0; i < files.size(); i++) {
+				std::cout << files[i].string() << ": " << codes[i] << '\n' << messages[i];
+				if (res == Verdicts::AC) res = codes[i];
+			}
+			std::cout.flush();
+			exitVerdict(res);
+		#else
+			(void)argc;
+			(void)argv;
+			(void)source;
+			(void)jobs;
+			judgeAssert<std::logic_error>(false, "InputValidator: batch mode is not supported with STREAM_FALLBACK!");
+		#endif
+		}
+
+		// the recorded result of a validator run
+		struct Memo {
+			int exitCode;
+			std::string messages;
+			std::string errors;
+			std::optional<std::string> constraints;
+		};
+
+		constexpr std::string_view MEMO_MAGIC = "VMEMO2";
+
+		std::optional<Memo> readMemo(const std::filesystem::path& file) {
+			auto content = ::details::readFile(file);
+			if (!content) return std::nullopt;
+			// "<magic> <exit code> <messages length> <errors length> <constraints length or -1>\n<messages><errors><constraints>"
+			std::istringstream header(content->substr(0, content->find('\n')));
+			std::string magic;
+			Memo res = {};
+			std::size_t messages = 0;
+			std::size_t errors = 0;
+			long long constraints = 0;
+			if (!(header >> magic >> res.exitCode >> messages >> errors >> constraints) or magic != MEMO_MAGIC) return std::nullopt;
+			std::size_t begin = static_cast<std::size_t>(header.str().size()) + 1;
+			std::size_t length = messages + errors + static_cast<std::size_t>(std::max(constraints, 0ll));
+			if (constraints < -1 or begin > content->size() or content->size() - begin != length) return std::nullopt;
+			res.messages = content->substr(begin, messages);
+			res.errors = content->substr(begin + messages, errors);
+			if (constraints >= 0) res.constraints = content->substr(begin + messages + errors);
+			return res;
+		}
+
+		void writeMemo(const std::filesystem::path& file, const Memo& memo) {
+			std::ostringstream header;
+			header << MEMO_MAGIC << " " << memo.exitCode << " " << memo.messages.size() << " " << memo.errors.size() << " ";
+			header << (memo.constraints ? static_cast<long long>(memo.constraints->size()) : -1ll) << "\n";
+			::details::replaceFile(file, {header.str(), memo.messages, memo.errors, memo.constraints.value_or("")});
+		}
+
+		[[noreturn]] void replay(const Memo& memo, const std::optional<std::string>& constraintsFile) {
+			std::cout << memo.messages << std::flush;
+			std::cerr << memo.errors << std::flush;
+			if (constraintsFile and memo.constraints) std::ofstream(*constraintsFile, std::ios::binary) << *memo.constraints;
+			exitVerdict(memo.exitCode);
+		}
+
+		// replays the result of a previous run with the same binary, input, and arguments or records it,
+		// in the later case the validation runs in a forked child that returns from this function
+		// the current arguments are used, i.e., those of the file in batch mode
+		void memoize(const std::filesystem::path& directory) {
+		#ifndef STREAM_FALLBACK
+			auto binary = ::details::binaryHash();
+			auto input = ::details::openSource(STDIN_FILENO, false);
+			auto content = input->mapped();
+			if (!binary or !content) return;
+			// the key contains all arguments except for the memo directory, the batch options, and the path of the constraints file
+			// such that a batch run and a standalone run of the same file share their memo
+			UInteger key = ::details::hashBytes(*content, *binary);
+			std::vector<std::string> args = arguments.getRaw().asStrings();
+			std::optional<std::string> constraintsFile;
+			for (std::size_t i = 1; i < args.size(); i++) {
+				bool hasValue = i + 1 < args.size();
+				if ((args[i] == MEMO_COMMAND or args[i] == BATCH_COMMAND or args[i] == JOBS_COMMAND) and hasValue) {
+					i++;
+					continue;
+				}
+				key = ::details::hashBytes(args[i], key);
+				if (args[i] == CONSTRAINT_COMMAND and hasValue) constraintsFile = args[++i];
+			}
+			std::ostringstream name;
+			name << std::hex << std::setw(16) << std::setfill('0') << key << ".memo";
+			std::filesystem::path file = directory / name.str();
+			if (auto memo = readMemo(file)) replay(*memo, constraintsFile);
+
+			std::FILE* output = std::tmpfile();
+			if (output == nullptr) return;
+			std::FILE* errors = std::tmpfile();
+			if (errors == nullptr) {
+				std::fclose(output);
+				return;
+			}
+			std::error_code error;
+			std::filesystem::create_directories(directory, error);
+			std::filesystem::path constraintsTmp = file;
+			constraintsTmp += ".constraints" + std::to_string(std::random_device()());
+			ValidateBase::juryOut.flush();
+			std::cout.flush();
+			std::cerr.flush();
+			pid_t child = ::fork();
+			if (child < 0) {
+				std::fclose(output);
+				std::fclose(errors);
+				return;
+			}
+			if (child == 0) {
+				::dup2(::fileno(output), STDOUT_FILENO);
+				::dup2(::fileno(errors), STDERR_FILENO);
+				std::fclose(output);
+				std::fclose(errors);
+				for (std::size_t i = 1; i + 1 < args.size(); i++) {
+					if (args[i] == CONSTRAINT_COMMAND) args[i + 1] = constraintsTmp.string();
+				}
+				ValidateBase::details::setArguments(std::move(args));
+				return;
+			}
+			int status = 0;
+			while (::waitpid(child, &status, 0) < 0 and errno == EINTR) {}
+			Memo memo = {};
+			memo.exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+			std::array<char, 1 << 12> buffer;
+			for (auto [stream, target] : {std::pair{output, &memo.messages}, std::pair{errors, &memo.errors}}) {
+				std::rewind(stream);
+				for (std::size_t read; (read = std::fread(buffer.data(), 1, buffer.size(), stream)) > 0;) {
+					target->append(buffer.data(), read);
+				}
+				std::fclose(stream);
+			}
+			if (constraintsFile) {
+				memo.constraints = ::details::readFile(constraintsTmp);
+				std::filesystem::remove(constraintsTmp, error);
+			}
+			// only verdicts are recorded, crashes and timeouts are not
+			if (WIFEXITED(status) and (memo.exitCode == Verdicts::AC or memo.exitCode == Verdicts::WA)) writeMemo(file, memo);
+			replay(memo, constraintsFile);
+		#else
+			(void)directory;
+		#endif
+		}
+	}
+
 	void init(int argc, char** argv) {
 		spaceSensitive = true;
 		caseSensitive = true;
 
 		ValidateBase::details::init(argc, argv);
+		if (auto source = arguments[BATCH_COMMAND]) details::batch(argc, argv, source.asString(), arguments[JOBS_COMMAND].asInteger(1));
+		if (auto memo = arguments[MEMO_COMMAND]) details::memoize(memo.asString());
 		juryOut = OutputStream(std::cout);
 
 		testIn = InputStream(std::cin, spaceSensitive, caseSensitive, juryOut, Verdicts::WA, floatAbsTol, floatRelTol);
@@ -2987,17 +5364,130 @@ namespace OutputValidator {
 	InputStream teamAns;
 	OutputStream teamOut;
 
+	namespace details {
+	#ifndef STREAM_FALLBACK
+		// reads up to the next newline, returns false if the connection ends before
+		bool readLine(int fd, std::string& line) {
+			line.clear();
+			while (true) {
+				char c = 0;
+				auto res = ::read(fd, &c, 1);
+				if (res < 0 and errno == EINTR) continue;
+				if (res <= 0) return false;
+				if (c == '\n') return true;
+				line.push_back(c);
+			}
+		}
+
+		// a handler process forks the validator and reports its exit code
+		void handle(int connection, int argc, char** argv) {
+			std::string teamOutput, feedbackDir;
+			if (!readLine(connection, teamOutput) or !readLine(connection, feedbackDir)) ::_exit(0);
+			int fd = ::open(teamOutput.c_str(), O_RDONLY | O_CLOEXEC);
+			if (fd < 0) {
+				// the request is answered with FAIL instead of aborting the validator
+				std::ofstream(std::filesystem::path(feedbackDir) / JUDGE_MESSAGE, MESSAGE_MODE)
+				    << "OutputValidator: Could not open File: " << teamOutput << std::endl;
+				std::string reply = std::to_string(static_cast<int>(FAIL)) + "\n";
+				[[maybe_unused]] auto written = ::write(connection, reply.data(), reply.size());
+				::_exit(0);
+			}
+			pid_t child = ::fork();
+			if (child == 0) {
+				::close(connection);
+				::dup2(fd, STDIN_FILENO);
+				::close(fd);
+				std::vector<std::string> args(argv, argv + argc);
+				args[3] = feedbackDir;
+				ValidateBase::details::setArguments(std::move(args));
+				return;
+			}
+			::close(fd);
+			int status = 0;
+			while (child > 0 and ::waitpid(child, &status, 0) < 0 and errno == EINTR) {}
+			int code = 255;
+			if (child > 0 and WIFEXITED(status)) code = WEXITSTATUS(status);
+			if (child > 0 and WIFSIGNALED(status)) code = 128 + WTERMSIG(status);
+			std::string reply = std::to_string(code) + "\n";
+			[[maybe_unused]] auto written = ::write(connection, reply.data(), reply.size());
+			::_exit(0);
+		}
+	#endif
+
+		// accepts requests "<team output>\n<feedback dir>\n" on a UNIX socket and never returns in this process,
+		// instead this function returns in a forked child for each request, its exit code is sent back as "<code>\n"
+		void serve(int argc, char** argv, const std::string& path) {
+		#ifndef STREAM_FALLBACK
+			sockaddr_un address = {};
+			judgeAssert<std::invalid_argument>(path.size() < sizeof(address.sun_path), "OutputValidator: socket path is too long!");
+			address.sun_family = AF_UNIX;
+			std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+			// only the stale socket of a server that is gone may be replaced
+			struct stat existing = {};
+			if (::lstat(path.c_str(), &existing) == 0) {
+				judgeAssert<std::runtime_error>(S_ISSOCK(existing.st_mode), "OutputValidator: " + path + " exists and is not a socket!");
+				int probe = ::socket(AF_UNIX, SOCK_STREAM, 0);
+				bool live = probe >= 0 and ::connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+				if (probe >= 0) ::close(probe);
+				judgeAssert<std::runtime_error>(!live, "OutputValidator: another server listens on: " + path);
+				::unlink(path.c_str());
+			}
+			int server = ::socket(AF_UNIX, SOCK_STREAM, 0);
+			judgeAssert<std::runtime_error>(server >= 0, "OutputValidator: Could not create socket!");
+			bool listening = ::bind(server, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0 and
+			                 ::listen(server, SOMAXCONN) == 0;
+			judgeAssert<std::runtime_error>(listening, "OutputValidator: Could not listen on: " + path);
+			// finished handlers are reaped automatically
+			std::signal(SIGCHLD, SIG_IGN);
+			while (true) {
+				int connection = ::accept(server, nullptr, nullptr);
+				if (connection < 0) {
+					if (errno == EINTR or errno == ECONNABORTED) continue;
+					judgeAssert<std::runtime_error>(false, "OutputValidator: accept failed: " + std::string(std::strerror(errno)));
+				}
+				if (::fork() == 0) {
+					::close(server);
+					std::signal(SIGCHLD, SIG_DFL);
+					handle(connection, argc, argv);
+					return;
+				}
+				::close(connection);
+			}
+		#else
+			(void)argc;
+			(void)argv;
+			(void)path;
+			judgeAssert<std::logic_error>(false, "OutputValidator: server mode is not supported with STREAM_FALLBACK!");
+		#endif
+		}
+	}
+
 	void init(int argc, char** argv) {
 		ValidateBase::details::init(argc, argv);
-		juryOut = OutputStream(std::filesystem::path(arguments[3]) / JUDGE_MESSAGE, MESSAGE_MODE);
-		teamOut = OutputStream(std::filesystem::path(arguments[3]) / TEAM_MESSAGE, MESSAGE_MODE);
 
 		testIn = InputStream(std::filesystem::path(arguments[1]), false, caseSensitive, juryOut, Verdicts::FAIL);
 		juryAns = InputStream(std::filesystem::path(arguments[2]), false, caseSensitive, juryOut, Verdicts::FAIL);
+		if (auto cache = arguments[JURY_CACHE_COMMAND]) juryAns.useTokenCache(cache.asString());
+		if (auto server = arguments[SERVER_COMMAND]) {
+			// everything that is parsed now is shared by all requests
+			testIn.useTokenCache();
+			juryAns.useTokenCache();
+			details::serve(argc, argv, server.asString());
+		}
+
+		juryOut = OutputStream(std::filesystem::path(arguments[3]) / JUDGE_MESSAGE, MESSAGE_MODE);
+		teamOut = OutputStream(std::filesystem::path(arguments[3]) / TEAM_MESSAGE, MESSAGE_MODE);
 		teamAns = InputStream(std::cin, spaceSensitive, caseSensitive, juryOut, Verdicts::WA);
+		teamAns.limitTokenLength(maxTokenLength);
+		teamAns.limitLength(outputLimit);
 		initConstraints();
 	}
 
+	// compares teamAns with juryAns token by token
+	void compareAll() {
+		teamAns.expectSame(juryAns, floatAbsTol, floatRelTol);
+	}
+
 } // namespace OutputValidator
 
 //called as ./interactor input judgeanswer feedbackdir <> teamoutput
@@ -3005,6 +5495,124 @@ namespace Interactor {
 	using namespace ValidateBase;
 	using namespace Verdicts;
 
+	namespace details {
+		std::unique_ptr<::details::RoundTimer> roundTimer;
+
+		void reportRounds() {
+			juryOut << roundTimer->summary() << std::endl;
+		}
+
+		std::unique_ptr<::details::TranscriptWriter> transcript;
+
+		// replays a transcript instead of talking to a team:
+		// everything written to toTeam is compared with the recorded messages and fromTeam reads the recorded responses
+		class Replay final {
+			using Transcript = ::details::TranscriptWriter;
+
+			std::string sent;	// all messages to the team
+			std::vector<std::pair<std::size_t, std::string>> responses;	// the bytes sent before each response and the response
+			std::size_t checked;	// bytes of sent that were compared
+			std::size_t next;	// responses that were read
+
+			void check(std::string_view data) {
+				std::size_t length = std::min(data.size(), sent.size() - checked);
+				auto [it, _] = std::mismatch(data.begin(), data.begin() + length, sent.begin() + checked);
+				if (it != data.end()) {
+					juryOut << "Replay: toTeam differs from the transcript at byte " << checked + (it - data.begin()) << FAIL;
+				}
+				checked += data.size();
+			}
+
+			class Output final : public std::streambuf {
+				Replay& replay;
+			protected:
+				std::streamsize xsputn(const char* s, std::streamsize n) override {
+					replay.check(std::string_view(s, static_cast<std::size_t>(n)));
+					return n;
+				}
+				int overflow(int c = std::char_traits<char>::eof()) override {
+					if (c != std::char_traits<char>::eof()) {
+						char x = std::char_traits<char>::to_char_type(c);
+						replay.check(std::string_view(&x, 1));
+					}
+					return std::char_traits<char>::not_eof(c);
+				}
+			public:
+				explicit Output(Replay& replay_) : replay(replay_) {}
+			} output;
+
+			class Input final : public std::streambuf {
+				Replay& replay;
+			protected:
+				int underflow() override {
+					if (gptr() < egptr()) return std::char_traits<char>::to_int_type(*gptr());
+					if (replay.next == replay.responses.size()) return std::char_traits<char>::eof();
+					auto& [before, data] = replay.responses[replay.next++];
+					if (replay.checked < before) {
+						juryOut << "Replay: fromTeam is read before byte " << before << " was sent to the team" << FAIL;
+					}
+					setg(data.data(), data.data(), data.data() + data.size());
+					return std::char_traits<char>::to_int_type(*gptr());
+				}
+			public:
+				explicit Input(Replay& replay_) : replay(replay_) {}
+			} input;
+
+		public:
+			std::ostream toTeam;
+			std::istream fromTeam;
+
+			explicit Replay(const std::filesystem::path& path) : checked(0), next(0), output(*this), input(*this), toTeam(&output), fromTeam(&input) {
+				auto content = ::details::readFile(path);
+				judgeAssert<std::runtime_error>(content.has_value(), "Replay: Could not open File: " + path.string());
+				std::string_view rest = *content;
+				judgeAssert<std::runtime_error>(rest.substr(0, ::details::TRANSCRIPT_MAGIC.size()) == ::details::TRANSCRIPT_MAGIC, "Replay: invalid transcript!");
+				rest.remove_prefix(::details::TRANSCRIPT_MAGIC.size());
+				while (!rest.empty()) {
+					judgeAssert<std::runtime_error>(rest.size() >= 5, "Replay: invalid transcript!");
+					char direction = rest[0];
+					std::size_t length = 0;
+					for (std::size_t i = 0; i < 4; i++) length |= static_cast<std::size_t>(static_cast<unsigned char>(rest[i + 1])) << (8 * i);
+					rest.remove_prefix(5);
+					judgeAssert<std::runtime_error>(length <= rest.size(), "Replay: invalid transcript!");
+					if (direction == Transcript::TO_TEAM) sent.append(rest.substr(0, length));
+					else if (direction == Transcript::FROM_TEAM) responses.emplace_back(sent.size(), rest.substr(0, length));
+					else judgeAssert<std::runtime_error>(false, "Replay: invalid transcript!");
+					rest.remove_prefix(length);
+				}
+				// the verdict cannot be caught by the std::ostream
+				toTeam.exceptions(std::ios::badbit);
+			}
+
+			Replay(const Replay&) = delete;
+			Replay& operator=(const Replay&) = delete;
+
+			// the reason why the transcript was not replayed completely, if it was not
+			std::optional<std::string> incomplete() const {
+				if (checked < sent.size()) {
+					return "Replay: toTeam ended after " + std::to_string(checked) + " of " +
+					       std::to_string(sent.size()) + " bytes of the transcript";
+				}
+				if (next < responses.size()) {
+					return "Replay: fromTeam read only " + std::to_string(next) + " of " +
+					       std::to_string(responses.size()) + " responses of the transcript";
+				}
+				return std::nullopt;
+			}
+		};
+
+		std::unique_ptr<Replay> replay;
+
+		// a replay that ends before the transcript does fails, whatever the verdict was
+		int finishReplay(int exitCode) {
+			if (exitCode == Verdicts::FAIL) return exitCode;
+			auto reason = replay->incomplete();
+			if (!reason) return exitCode;
+			juryOut << *reason << std::endl;
+			return Verdicts::FAIL;
+		}
+	}
+
 	OutputStream toTeam;
 	InputStream testIn;
 	InputStream fromTeam;
@@ -3014,10 +5622,35 @@ namespace Interactor {
 		ValidateBase::details::init(argc, argv);
 		juryOut = OutputStream(std::filesystem::path(arguments[3]) / JUDGE_MESSAGE, MESSAGE_MODE);
 		teamOut = OutputStream(std::filesystem::path(arguments[3]) / TEAM_MESSAGE, MESSAGE_MODE);
-		toTeam = OutputStream(std::cout);
-
 		testIn = InputStream(std::filesystem::path(arguments[1]), false, caseSensitive, juryOut, Verdicts::FAIL);
-		fromTeam = InputStream(std::cin, spaceSensitive, caseSensitive, juryOut, Verdicts::WA);
+		if (auto replay = arguments[REPLAY_COMMAND]) {
+			details::replay = std::make_unique<details::Replay>(replay.asString());
+			toTeam = OutputStream(details::replay->toTeam);
+			fromTeam = InputStream(details::replay->fromTeam, spaceSensitive, caseSensitive, juryOut, Verdicts::WA);
+			Verdicts::Verdict::beforeExit = details::finishReplay;
+		} else {
+		#ifndef STREAM_FALLBACK
+			toTeam = OutputStream(std::cout, STDOUT_FILENO);
+		#else
+			toTeam = OutputStream(std::cout);
+		#endif
+			fromTeam = InputStream(std::cin, spaceSensitive, caseSensitive, juryOut, Verdicts::WA);
+		}
+		fromTeam.tie(toTeam);
+		if (auto transcript = arguments[TRANSCRIPT_COMMAND]) {
+			details::transcript = std::make_unique<::details::TranscriptWriter>(transcript.asString());
+			toTeam.recordTranscript(details::transcript.get());
+		}
+		if (responseTimeout >= 0) fromTeam.limitWaitTime(responseTimeout);
+
+		if (auto latency = arguments[LATENCY_COMMAND]) {
+			if (latency.parameterCount() > 0) details::roundTimer = std::make_unique<::details::RoundTimer>(latency.asString());
+			else details::roundTimer = std::make_unique<::details::RoundTimer>();
+			toTeam.timeRounds(details::roundTimer.get());
+			std::atexit(details::reportRounds);
+		}
+		fromTeam.limitTokenLength(maxTokenLength);
+		fromTeam.limitLength(outputLimit);
 	}
 
 } // namespace Interactor
@@ -3064,7 +5697,7 @@ namespace Multipass {
 			judgeAssert<std::runtime_error>(file.good(), "NEXT(): Could not open file: nextpass.in");
 			file << details::nextpassBuffer.str();
 		}
-		exitVerdict(Verdicts::AC);
+		Verdicts::AC.exit();
 	}
 	[[noreturn]] std::ostream& NEXT(std::ostream& os) {
 		os << std::endl;
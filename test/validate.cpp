@@ -316,6 +316,20 @@ void checkCommandParser() {
 	assert(arguments["--test4"].asInteger(5) == 5);
 }
 
+// an input that never ends
+class EndlessStreambuf final : public std::streambuf {
+	std::array<char, 4096> buffer;
+protected:
+	int_type underflow() override {
+		setg(buffer.data(), buffer.data(), buffer.data() + buffer.size());
+		return traits_type::to_int_type(buffer[0]);
+	}
+public:
+	explicit EndlessStreambuf(char c) {
+		buffer.fill(c);
+	}
+};
+
 void checkInputStream() {
 	assertNoException([](){
 		std::istringstream rawIn("Das   ist 1 test\n");
@@ -333,6 +347,24 @@ void checkInputStream() {
 		in.newline();
 		in.eof();
 	});
+	assertNoException([](){
+		std::istringstream rawIn("DAS  ist 1\n");
+		using Lenient = BasicInputStream<InputPolicy::SpaceInsensitive, InputPolicy::CaseInsensitive>;
+		Lenient in(rawIn, ValidateBase::juryOut, Verdicts::FAIL);
+
+		in.expectString("das");
+		in.space();
+		assert(in.string() == "ist");
+		assert(in.integer(1, 2) == 1);
+		in.newline();
+		in.eof();
+	});
+	assertExit([](){
+		std::istringstream rawIn("1  2\n");
+		using Strict = BasicInputStream<InputPolicy::SpaceSensitive, InputPolicy::CaseSensitive>;
+		Strict in(rawIn, ValidateBase::juryOut, Verdicts::Verdict(23));
+		in.integers(2);
+	}, 23);
 	assertNoException([](){
 		std::istringstream rawIn("Das   ist 1 test\n");
 		InputStream in(rawIn, false, true, ValidateBase::juryOut, Verdicts::FAIL);
@@ -544,6 +576,600 @@ void checkInputStream() {
 		in.expectString("ende");
 		in.eof();
 	});
+	assertNoException([](){
+		std::istringstream rawIn("Das ist EIN test");
+		InputStream in(rawIn, false, false, ValidateBase::juryOut, Verdicts::FAIL);
+
+		assert(in.stringView() == "das");
+		assert(in.stringView(3, 4) == "ist");
+		assert(in.stringView(std::regex("[a-z]*")) == "ein");
+		Constraint constraint;
+		assert(in.stringView(std::regex("[a-z]*"), 4, 5, constraint) == "test");
+		in.eof();
+	});
+	assertExit([](){
+		std::istringstream rawIn("test");
+		InputStream in(rawIn, true, true, ValidateBase::juryOut, Verdicts::Verdict(23));
+		in.stringView(1, 4);
+	}, 23);
+	assertExit([](){
+		EndlessStreambuf buf('a');
+		std::istream rawIn(&buf);
+		InputStream in(rawIn, false, true, ValidateBase::juryOut, Verdicts::Verdict(23));
+		in.limitTokenLength(1'000'000);
+		in.string();
+	}, 23);
+	assertExit([](){
+		EndlessStreambuf buf('a');
+		std::istream rawIn(&buf);
+		InputStream in(rawIn, true, true, ValidateBase::juryOut, Verdicts::Verdict(23));
+		in.string(1, 10);
+	}, 23);
+	assertNoException([](){
+		std::istringstream rawIn("abc abcd");
+		InputStream in(rawIn, true, true, ValidateBase::juryOut, Verdicts::FAIL);
+		in.limitTokenLength(4);
+		assert(in.string(3, 4) == "abc");
+		in.space();
+		assert(in.string() == "abcd");
+	});
+	assertNoException([](){
+		std::istringstream rawIn("#..#\n.##.\n....\n");
+		InputStream in(rawIn, true, true, ValidateBase::juryOut, Verdicts::FAIL);
+
+		Matrix<char> grid = in.grid(3, 4, ".#");
+		in.newline();
+		in.eof();
+		assert(grid.rows() == 3 and grid.cols() == 4);
+		assert(std::string(grid[1], grid.cols()) == ".##.");
+		assert(std::count(grid.begin(), grid.end(), '#') == 4);
+	});
+	assertNoException([](){
+		std::istringstream rawIn("\n\n\n");
+		InputStream in(rawIn, true, true, ValidateBase::juryOut, Verdicts::FAIL);
+		assert(in.grid(3, 0, ".#").rows() == 3);
+		in.newline();
+		in.eof();
+	});
+	assertExit([](){
+		std::istringstream rawIn("\n.\n");
+		InputStream in(rawIn, true, true, ValidateBase::juryOut, Verdicts::Verdict(23));
+		in.grid(2, 0, ".");
+		in.newline();
+	}, 23);
+	assertNoException([](){
+		std::istringstream rawIn("aB\nCd");
+		InputStream in(rawIn, false, false, ValidateBase::juryOut, Verdicts::FAIL);
+		assert(std::string(in.grid(2, 2, "ABCD").data(), 4) == "abcd");
+	});
+	assertNoException([](){
+		std::istringstream rawIn("1 2 3\n4 5 6\n");
+		InputStream in(rawIn, true, true, ValidateBase::juryOut, Verdicts::FAIL);
+
+		Constraint constraint;
+		Matrix<Integer> matrix = in.matrix(2, 3, 1, 7, constraint);
+		in.newline();
+		in.eof();
+		assert(matrix.rows() == 2 and matrix.cols() == 3);
+		assert(matrix[1][0] == 4 and matrix[0][2] == 3);
+		assert(std::vector<Integer>(matrix.begin(), matrix.end()) == range(1, 7));
+	});
+	assertExit([](){
+		std::istringstream rawIn("1 2\n3 4 ");
+		InputStream in(rawIn, true, true, ValidateBase::juryOut, Verdicts::Verdict(23));
+		in.matrix(2, 2);
+		in.newline();
+	}, 23);
+	assertExit([](){
+		std::istringstream rawIn("1 2 3 4");
+		InputStream in(rawIn, true, true, ValidateBase::juryOut, Verdicts::Verdict(23));
+		in.matrix(2, 2);
+	}, 23);
+	assertExit([](){
+		std::istringstream rawIn("1 2\n3 4");
+		InputStream in(rawIn, true, true, ValidateBase::juryOut, Verdicts::Verdict(23));
+		in.matrix(2, 2, 1, 4);
+	}, 23);
+	assertExit([](){
+		std::istringstream rawIn("..\n...\n");
+		InputStream in(rawIn, true, true, ValidateBase::juryOut, Verdicts::Verdict(23));
+		in.grid(2, 2, ".");
+	}, 23);
+	{
+		std::ostringstream message;
+		OutputStream messageOut(message);
+		assertExit([&](){
+			std::istringstream rawIn("...\n.x.\n");
+			InputStream in(rawIn, true, true, messageOut, Verdicts::Verdict(23));
+			in.grid(2, 3, ".#");
+		}, 23);
+		assert(message.str().find("Line: 2, Char: 1\n.x.\n ^\n") != std::string::npos);
+	}
+	assertNoException([](){
+		std::istringstream rawIn("1\n2\n3\n-1.5 2.5\n");
+		InputStream in(rawIn, true, true, ValidateBase::juryOut, Verdicts::FAIL);
+
+		assert(in.integers(3, 1, 4, NEWLINE) == std::vector<Integer>{1, 2, 3});
+		in.newline();
+		assert(in.reals(2, -2, 3) == std::vector<Real>{-1.5, 2.5});
+		in.newline();
+		in.eof();
+	});
+	assertExit([](){
+		std::istringstream rawIn("1\n2 3\n");
+		InputStream in(rawIn, true, true, ValidateBase::juryOut, Verdicts::Verdict(23));
+		in.integers(3, NEWLINE);
+	}, 23);
+	assertNoException([](){
+		std::string data;
+		for (Integer i = 0; i < 300'000; i++) data += std::to_string(i) + (i % 10 == 9 ? '\n' : ' ');
+		std::istringstream rawIn(data);
+		InputStream in(rawIn, true, true, ValidateBase::juryOut, Verdicts::FAIL);
+		for (Integer i = 0; i < 300'000; i++) {
+			assert(in.integer() == i);
+			if (i % 10 == 9) in.newline();
+			else in.space();
+		}
+		in.eof();
+	});
+	assertNoException([](){
+		auto path = std::filesystem::temp_directory_path() / "validate_test.in";
+		{
+			std::ofstream file(path);
+			file << "Das ist\n1 test\n";
+		}
+		{
+			InputStream in(path, true, true, ValidateBase::juryOut, Verdicts::FAIL);
+			in.expectString("Das");
+			in.space();
+			in.expectString("ist");
+			in.newline();
+			in.expectInt(1);
+			in.space();
+			in.expectString("test");
+			in.newline();
+			in.eof();
+		}
+		std::filesystem::remove(path);
+	});
+	assertExit([](){
+		EndlessStreambuf buf('\n');
+		std::istream rawIn(&buf);
+		InputStream in(rawIn, false, true, ValidateBase::juryOut, Verdicts::Verdict(23));
+		in.limitLength(10'000'000);
+		in.eof();
+	}, 23);
+	assertNoException([](){
+		std::istringstream rawIn("ab cd\n");
+		InputStream in(rawIn, true, true, ValidateBase::juryOut, Verdicts::FAIL);
+		in.limitLength(6);
+		in.expectString("ab");
+		in.space();
+		in.expectString("cd");
+		in.newline();
+		in.eof();
+	});
+	assertExit([](){
+		std::istringstream rawIn("ab cd\n");
+		InputStream in(rawIn, true, true, ValidateBase::juryOut, Verdicts::Verdict(23));
+		in.limitLength(4);
+		in.expectString("ab");
+		in.space();
+		in.string();
+	}, 23);
+	assertExit([](){
+		auto path = std::filesystem::temp_directory_path() / "validate_limit.in";
+		{
+			std::ofstream file(path);
+			file << "ab cd\n";
+		}
+		InputStream in(path, true, true, ValidateBase::juryOut, Verdicts::Verdict(23));
+		std::filesystem::remove(path);
+		in.limitLength(5);
+		in.expectString("ab");
+		in.space();
+		in.expectString("cd");
+		in.newline();
+	}, 23);
+	{
+		std::ostringstream message;
+		OutputStream messageOut(message);
+		assertExit([&](){
+			std::istringstream rawIn("1 2\n3 x 5\n");
+			InputStream in(rawIn, false, true, messageOut, Verdicts::Verdict(23));
+			in.integers(3);
+			in.integer();
+		}, 23);
+		assert(message.str().find("Line: 2, Char: 2\n3 x 5\n  ^") != std::string::npos);
+	}
+	{
+		std::ostringstream message;
+		OutputStream messageOut(message);
+		assertExit([&](){
+			std::string data;
+			for (int i = 0; i < 300000; i++) data += "12345\n";
+			data += "7 -8 9\n";
+			std::istringstream rawIn(data);
+			InputStream in(rawIn, true, true, messageOut, Verdicts::Verdict(23));
+			in.integers(300000, NEWLINE);
+			in.newline();
+			in.integer();
+			in.space();
+			in.integer(0, 10);
+		}, 23);
+		assert(message.str().find("Line: 300001, Char: 2\n7 -8 9\n  ^~") != std::string::npos);
+	}
+	{
+		std::ostringstream message;
+		OutputStream messageOut(message);
+		assertExit([&](){
+			std::string data = std::string(100, 'a') + " \t\n\n  \r\n" + std::string(40, ' ') + "\n\n\n" + std::string(20, ' ') + "b";
+			std::istringstream rawIn(data);
+			InputStream in(rawIn, false, true, messageOut, Verdicts::Verdict(23));
+			assert(in.string() == std::string(100, 'a'));
+			in.expectString("c");
+		}, 23);
+		assert(message.str().find("Line: 7, Char: 20\n") != std::string::npos);
+	}
+	for (int i = 0; i < 1000; i++) {
+		// random contents with a random density of whitespace, checked from every offset
+		constexpr std::string_view spaces = " \t\n\r\v\f";
+		constexpr std::string_view others = "\x01x\x80!~";
+		constexpr Real densities[] = {0.01, 0.1, 0.5, 0.9, 0.99};
+		Real density = Random::select(densities);
+		std::string data(static_cast<std::size_t>(Random::integer(0, 200)), ' ');
+		for (char& c : data) c = Random::real(0, 1) < density ? Random::select(spaces) : Random::select(others);
+		const char* end = data.data() + data.size();
+		for (const char* begin = data.data(); begin != end; begin++) {
+			const char* space = begin;
+			while (space != end and !details::isSpace(*space)) space++;
+			const char* nonSpace = begin;
+			while (nonSpace != end and details::isSpace(*nonSpace)) nonSpace++;
+			assert(details::findSpace<true>(begin, end) == space);
+			assert(details::findSpace<false>(begin, end) == nonSpace);
+		}
+	}
+}
+
+void checkExpectSame(const std::string& jury, const std::string& team, bool spaceSensitive, bool caseSensitive, bool same) {
+	auto compare = [&](){
+		std::istringstream rawJury(jury);
+		std::istringstream rawTeam(team);
+		InputStream juryAns(rawJury, false, caseSensitive, ValidateBase::juryOut, Verdicts::FAIL);
+		InputStream teamAns(rawTeam, spaceSensitive, caseSensitive, ValidateBase::juryOut, Verdicts::Verdict(23));
+		teamAns.expectSame(juryAns);
+	};
+	if (same) assertNoException(compare);
+	else assertExit(compare, 23);
+}
+
+void checkExpectSame() {
+	std::string prefix;
+	for (Integer i = 0; i < 100'000; i++) prefix += std::to_string(i) + (i % 10 == 9 ? "\n" : " ");
+	checkExpectSame(prefix, prefix, true, true, true);
+	checkExpectSame(prefix + "123456 x\n", prefix + "123456 x\n", true, true, true);
+	checkExpectSame(prefix + "123456 x\n", prefix + "123457 x\n", true, true, false);
+	checkExpectSame(prefix + "abc\n", prefix + "abcd\n", false, true, false);
+	checkExpectSame(prefix + "abc\n", prefix + "ABC\n", false, true, false);
+	checkExpectSame(prefix + "abc\n", prefix + "ABC\n", false, false, true);
+	checkExpectSame(prefix, prefix + "1", false, true, false);
+	checkExpectSame(prefix + "1", prefix, false, true, false);
+	checkExpectSame("1.0 2\n", "1.0000001   2.0", false, true, true);
+	checkExpectSame("1.0 2\n", "1.0000001 2.0\n", true, true, true);
+	checkExpectSame("1.0 2\n", "1.0 2\n\n", true, true, false);
+	checkExpectSame("1.0 2\n", "1.0  2\n", true, true, false);
+	checkExpectSame("1.0 2\n", "1.0 2.1\n", false, true, false);
+	checkExpectSame("1.0 2\n", "1.0 x\n", false, true, false);
+	checkExpectSame("", "", true, true, true);
+	checkExpectSame("\n", "", false, true, true);
+}
+
+void checkExpectReals(const std::string& team, const std::vector<Real>& expected, bool same,
+                      Real floatAbsTol = DEFAULT_EPS, Real floatRelTol = DEFAULT_EPS) {
+	auto compare = [&](){
+		std::istringstream rawTeam(team);
+		InputStream teamAns(rawTeam, false, true, ValidateBase::juryOut, Verdicts::Verdict(23), floatAbsTol, floatRelTol);
+		teamAns.expectReals(expected);
+		teamAns.eof();
+	};
+	if (same) assertNoException(compare);
+	else assertExit(compare, 23);
+}
+
+void checkExpectReals() {
+	constexpr Real INF = std::numeric_limits<Real>::infinity();
+	std::vector<Real> expected;
+	std::string team;
+	for (Integer i = 0; i < 1000; i++) {
+		expected.push_back(i / 7.0_real);
+		team += std::to_string(static_cast<double>(i) / 7.0 + 1e-8) + " ";
+	}
+	checkExpectReals(team, expected, true);
+	checkExpectReals("1 2 3", {1, 2, 3}, true);
+	checkExpectReals("1 2 3.1", {1, 2, 3}, false);
+	checkExpectReals("1 2", {1, 2, 3}, false);
+	checkExpectReals("1e9 1.0000001e9", {1e9, 1e9}, true);
+	checkExpectReals("1e9 1.00001e9", {1e9, 1e9}, false);
+	checkExpectReals("1e18", {-INF}, false);
+	checkExpectReals("nan", {std::numeric_limits<Real>::quiet_NaN()}, false);
+	checkExpectReals("1", {std::numeric_limits<Real>::quiet_NaN()}, false);
+	checkExpectReals("", {}, true);
+	// an infinite tolerance does not make finite and infinite values equal
+	checkExpectReals("5", {INF}, false, INF, 0);
+	checkExpectReals("5", {INF}, false, 0, INF);
+	checkExpectReals("5", {5}, true, INF, INF);
+	for (Real floatAbsTol : {0.0_real, INF}) {
+		for (Real floatRelTol : {0.0_real, INF}) {
+			std::vector<Real> given = {1, 2, INF, 4};
+			std::vector<Real> want = {1, 2, 5, 4};
+			assert(details::firstUnequal(given.data(), want.data(), given.size(), floatAbsTol, floatRelTol) == 2);
+			assert(details::firstUnequal(want.data(), given.data(), given.size(), floatAbsTol, floatRelTol) == 2);
+		}
+	}
+	assertNoException([](){
+		std::istringstream rawTeam("0.5");
+		InputStream teamAns(rawTeam, false, true, ValidateBase::juryOut, Verdicts::Verdict(23));
+		teamAns.expectReal(0.5);
+	});
+	{
+		std::ostringstream message;
+		OutputStream messageOut(message);
+		assertExit([&](){
+			std::string data;
+			for (Integer i = 0; i < 100; i++) data += std::to_string(i) + "\n";
+			expected.assign(100, 0);
+			std::iota(expected.begin(), expected.end(), 0);
+			expected[70] = 5;
+			std::istringstream rawIn(data);
+			InputStream in(rawIn, false, true, messageOut, Verdicts::Verdict(23));
+			in.expectReals(expected.begin(), expected.end(), NEWLINE);
+		}, 23);
+		assert(message.str().find("Expected 5.000000 but got 70.000000 at index 70!") != std::string::npos);
+		assert(message.str().find("Line: 71, Char: 0\n70\n^~") != std::string::npos);
+	}
+	// a mismatch is reported before a later error in the same block
+	for (std::string team : {"1 2 x", "1 2", "1 2  3", "1 2\n3"}) {
+		std::ostringstream message;
+		OutputStream messageOut(message);
+		assertExit([&](){
+			std::istringstream rawTeam(team);
+			InputStream teamAns(rawTeam, true, true, messageOut, Verdicts::Verdict(23));
+			teamAns.expectReals({5, 2, 3});
+		}, 23);
+		assert(message.str().find("Expected 5.000000 but got 1.000000 at index 0!") != std::string::npos);
+	}
+	{
+		std::ostringstream message;
+		OutputStream messageOut(message);
+		assertExit([&](){
+			std::istringstream rawTeam("1 2 x");
+			InputStream teamAns(rawTeam, true, true, messageOut, Verdicts::Verdict(23));
+			teamAns.expectReals({1, 2, 3});
+		}, 23);
+		assert(message.str().find("does not match pattern!") != std::string::npos);
+	}
+}
+
+// the regex based implementation is used as reference
+void checkIntegerToken(const std::string& s, const std::source_location location = std::source_location::current()) {
+	Integer expected = 0;
+	bool match = std::regex_match(s, INTEGER_REGEX);
+	bool valid = match and details::parse<Integer>(s, expected);
+	Integer seen = 0;
+	auto result = details::parseInteger(s, seen);
+	assert((result == details::TokenResult::MISMATCH) == !match, location);
+	assert((result == details::TokenResult::VALID) == valid, location);
+	if (valid) assert(seen == expected, location);
+}
+
+void checkIntegerParser() {
+	for (std::string s : {"", "0", "-0", "00", "01", "-", "+1", "1-", "10", "-10", " 1", "1 ",
+	                      "9223372036854775807", "-9223372036854775808",
+	                      "9223372036854775808", "-9223372036854775809",
+	                      "18446744073709551615", "18446744073709551616", "99999999999999999999",
+	                      "123456789012345678901234567890", "12345678901234567890123456789x"}) {
+		checkIntegerToken(s);
+	}
+	for (Integer i = 0; i < 100'000; i++) {
+		std::string s = Random::string(Random::integer(1, 25), "-0123456789");
+		checkIntegerToken(s);
+		if (s[0] != '-') checkIntegerToken("-" + s);
+	}
+	for (Integer i = 0; i < 100'000; i++) {
+		checkIntegerToken(std::to_string(Random::integer(std::numeric_limits<Integer>::min(), std::numeric_limits<Integer>::max())));
+	}
+	assertNoException([](){
+		std::istringstream rawIn("-12 1.5");
+		InputStream in(rawIn, false, true, ValidateBase::juryOut, Verdicts::FAIL);
+		assert(in.string(INTEGER_REGEX) == "-12");
+		assert(in.string(REAL_REGEX) == "1.5");
+	});
+	// the constants refer to the lazily compiled regexes
+	assert(&INTEGER_REGEX == &integerRegex());
+	assert(&REAL_REGEX == &realRegex());
+	assert(&STRICT_REAL_REGEX == &strictRealRegex());
+}
+
+void checkRealToken(const std::string& s, const std::source_location location = std::source_location::current()) {
+	Real expected = 0;
+	bool match = std::regex_match(s, REAL_REGEX);
+	bool valid = match and details::parse<Real>(s, expected);
+	Real seen = 0;
+	auto result = details::parseReal(s, seen);
+	assert((result == details::TokenResult::MISMATCH) == !match, location);
+	assert((result == details::TokenResult::VALID) == valid, location);
+	if (valid) assert(seen == expected and std::signbit(seen) == std::signbit(expected), location);
+
+	expected = 0;
+	match = std::regex_match(s, STRICT_REAL_REGEX);
+	valid = match and details::parse<Real>(s, expected);
+	auto dot = s.find('.');
+	Integer expectedDecimals = dot == std::string::npos ? 0 : s.size() - dot - 1;
+	seen = 0;
+	Integer decimals = 0;
+	result = details::parseRealStrict(s, seen, decimals);
+	assert((result == details::TokenResult::MISMATCH) == !match, location);
+	assert((result == details::TokenResult::VALID) == valid, location);
+	if (match) assert(decimals == expectedDecimals, location);
+	if (valid) assert(seen == expected and std::signbit(seen) == std::signbit(expected), location);
+}
+
+void checkRealParser() {
+	for (std::string s : {"", "0", "-0", "+0", "00", ".", "-.", "0.", ".0", "1e", "1e+", "e5", ".e5", "1.e5", ".5e-5",
+	                      "1E5", "1e5.", "--1", "+-1", "1-", "0.5", "-0.5", "05", "05.5", "00.5", "-05",
+	                      "0.00000000000000000000001", "1e-5000", "1e5000", "0e5000", "123456789012345678901234567890",
+	                      "1.000000000000000000000000000000001", "100000000000000000000000000000.5",
+	                      "3.14159265358979323846264338327950288", "9007199254740993", "18446744073709551617",
+	                      "0.1", "0.2", "0.3", "1e27", "1e28", "1e-27", "1e-28", "123456789e22", "4.9e-324"}) {
+		checkRealToken(s);
+	}
+	for (Integer i = 0; i < 100'000; i++) {
+		checkRealToken(Random::string(Random::integer(1, 12), "-+.eE0123456789"));
+	}
+	for (Integer i = 0; i < 100'000; i++) {
+		std::string s = Random::string(Random::integer(1, 20), DIGITS);
+		s.insert(Random::integer(0, std::ssize(s) + 1), ".");
+		if (Random::bit()) s = "-" + s;
+		if (Random::bit()) s += "e" + std::to_string(Random::integer(-40, 40));
+		checkRealToken(s);
+	}
+}
+
+void checkTokenCache() {
+	auto directory = std::filesystem::temp_directory_path() / "validate_cache";
+	auto path = std::filesystem::temp_directory_path() / "validate_cache.ans";
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directory(directory);
+	{
+		std::ofstream file(path);
+		file << "12 -3.5 abc\n" << std::string(100, ' ') << "7 1e3\n";
+	}
+	auto read = [&](){
+		InputStream in(path, false, true, ValidateBase::juryOut, Verdicts::FAIL);
+		in.useTokenCache(directory);
+		std::vector<Real> res;
+		res.push_back(static_cast<Real>(in.integer()));
+		res.push_back(in.real());
+		assert(in.string() == "abc");
+		res.push_back(in.real());
+		res.push_back(in.real());
+		in.eof();
+		return res;
+	};
+	std::vector<Real> expected = {12, -3.5, 7, 1000};
+	assert(read() == expected);
+	assert(read() == expected);
+	{
+		InputStream in(path, false, true, ValidateBase::juryOut, Verdicts::FAIL);
+		in.useTokenCache();
+		assert(in.integer() == 12);
+		assert(in.real() == -3.5);
+		assert(in.string() == "abc");
+		assert(in.integer() == 7);
+		assert(in.real() == 1000);
+		in.eof();
+	}
+#if !defined(STREAM_FALLBACK) && (defined(__linux__) || defined(__APPLE__))
+	assert(details::binaryHash().has_value());
+#endif
+	// only the mapped input of a hashable binary uses a cache
+	if (auto binary = details::binaryHash()) {
+		auto key = details::hashBytes("12 -3.5 abc\n" + std::string(100, ' ') + "7 1e3\n", *binary);
+		std::ostringstream name;
+		name << std::hex << std::setw(16) << std::setfill('0') << key << ".tokens";
+		auto sidecar = directory / name.str();
+		assert(std::filesystem::exists(sidecar));
+		std::string content = *details::readFile(sidecar);
+		// the sidecar is deterministic
+		std::filesystem::remove(sidecar);
+		assert(read() == expected);
+		assert(details::readFile(sidecar) == content);
+		// a modified entry is not trusted, the input is parsed again and the cache is replaced
+		using Entry = details::TokenCache::Entry;
+		constexpr std::size_t HEADER = 48;
+		constexpr std::size_t CHECKSUM = 32;
+		std::string modified = content;
+		Integer value = 42;
+		std::memcpy(modified.data() + HEADER + offsetof(Entry, integer), &value, sizeof(value));
+		std::ofstream(sidecar, std::ios::binary) << modified;
+		assert(read() == expected);
+		assert(details::readFile(sidecar) == content);
+		// entries outside of the input are rejected even with a matching checksum
+		for (UInteger begin : {UInteger(1) << 40, UInteger(200)}) {
+			modified = content;
+			std::memcpy(modified.data() + HEADER + 4 * sizeof(Entry), &begin, sizeof(begin));
+			UInteger checksum = details::hashBytes(std::string_view(modified).substr(HEADER), key);
+			std::memcpy(modified.data() + CHECKSUM, &checksum, sizeof(checksum));
+			std::ofstream(sidecar, std::ios::binary) << modified;
+			assert(read() == expected);
+			assert(details::readFile(sidecar) == content);
+		}
+		// unknown flags are rejected as well
+		modified = content;
+		std::uint32_t flags = 4;
+		std::memcpy(modified.data() + HEADER + offsetof(Entry, flags), &flags, sizeof(flags));
+		UInteger checksum = details::hashBytes(std::string_view(modified).substr(HEADER), key);
+		std::memcpy(modified.data() + CHECKSUM, &checksum, sizeof(checksum));
+		std::ofstream(sidecar, std::ios::binary) << modified;
+		assert(read() == expected);
+		assert(details::readFile(sidecar) == content);
+		// a broken cache is ignored and replaced
+		std::ofstream(sidecar, std::ios::binary) << content.substr(0, content.size() - 1);
+		assert(read() == expected);
+		assert(read() == expected);
+	}
+	std::filesystem::remove_all(directory);
+	std::filesystem::remove(path);
+}
+
+// std::regex is used as reference
+void checkTokenPattern(std::string_view pattern, std::string_view alphabet) {
+	for (bool caseSensitive : {true, false}) {
+		auto flags = std::regex::ECMAScript;
+		if (!caseSensitive) flags |= std::regex::icase;
+		std::regex reference(pattern.data(), pattern.size(), flags);
+		TokenPattern compiled(pattern, caseSensitive);
+		for (Integer i = 0; i < 2000; i++) {
+			std::string s = Random::string(Random::integer(0, 8), alphabet);
+			assert(compiled.matches(s) == std::regex_match(s, reference));
+		}
+	}
+}
+
+void checkTokenPattern() {
+	checkTokenPattern("[a-z]+", "abzAZ0");
+	checkTokenPattern("a|b|", "abc");
+	checkTokenPattern("(ab|a)*b?", "abc");
+	checkTokenPattern("x{2,3}y{0,}z{2}", "xyz");
+	checkTokenPattern("[^a-c]?[-x]\\d", "abcdx-09");
+	checkTokenPattern("(?:\\w\\W)+", "a_1.-");
+	checkTokenPattern(".[\\]\\-]a.", "a]-b\\");
+	checkTokenPattern("[Aa-c][^B]*", "aAbBcC");
+	checkTokenPattern("0|-?[1-9][0-9]*", "-0123");
+	checkTokenPattern("(a+?b)+c??", "abc");
+	for (std::string_view pattern : {"(", "a)", "[a", "*", "a{2", "a{3,2}", "\\q", "^a", "[z-a]", "(?=a)", "a{1001}"}) {
+		bool thrown = false;
+		try {TokenPattern compiled(pattern);} catch (const std::invalid_argument&) {thrown = true;}
+		assert(thrown);
+	}
+	TokenPattern word("[a-z]+(_[a-z]+)*");
+	std::string huge(1'000'000, 'a');
+	assert(word.matches(huge));
+	huge += "_b";
+	assert(word.matches(huge));
+	huge += "_";
+	assert(!word.matches(huge));
+	assertNoException([](){
+		std::istringstream rawIn("Hello world");
+		InputStream in(rawIn, false, false, ValidateBase::juryOut, Verdicts::FAIL);
+		assert(in.string(TokenPattern("hello", false)) == "hello");
+		assert(in.strings(1, TokenPattern("[a-z]+"), 1, 6) == std::vector<std::string>{"world"});
+	});
+	assertExit([](){
+		std::istringstream rawIn("abc1");
+		InputStream in(rawIn, false, true, ValidateBase::juryOut, Verdicts::Verdict(23));
+		in.string(TokenPattern("[a-z]+"));
+	}, 23);
 }
 
 void checkJoin() {
@@ -599,6 +1225,301 @@ void checkJoin() {
 	assert(join(std::make_pair(1, "2")).asString() == "1 2"sv);
 }
 
+template<typename T>
+void checkOutputStream(const T& x) {
+	std::ostringstream expected;
+	expected << std::boolalpha << std::fixed << std::setprecision(DEFAULT_PRECISION) << x;
+	std::ostringstream given;
+	OutputStream(given) << x;
+	assert(given.str() == expected.str());
+}
+
+void checkOutputStream() {
+	checkOutputStream<Integer>(0);
+	checkOutputStream<Integer>(-1);
+	checkOutputStream(std::numeric_limits<Integer>::min());
+	checkOutputStream(std::numeric_limits<Integer>::max());
+	checkOutputStream(std::numeric_limits<UInteger>::max());
+	checkOutputStream<short>(-7);
+	checkOutputStream('x');
+	checkOutputStream(static_cast<signed char>('x'));
+	checkOutputStream(true);
+	checkOutputStream("abc");
+	checkOutputStream(std::string("abc"));
+	checkOutputStream<Real>(0);
+	checkOutputStream<Real>(-0.0);
+	checkOutputStream<Real>(0.5);
+	checkOutputStream<Real>(-2.0000005);
+	checkOutputStream<Real>(123456789.123456789);
+	checkOutputStream<Real>(1e-7);
+	checkOutputStream<Real>(1e300);
+	checkOutputStream(std::numeric_limits<Real>::max());
+	checkOutputStream(std::numeric_limits<Real>::infinity());
+	checkOutputStream(-std::numeric_limits<Real>::quiet_NaN());
+	checkOutputStream(0.1);
+	checkOutputStream(2.5f);
+	Random::seed(4);
+	for (Integer i = 0; i < 10'000; i++) {
+		checkOutputStream(Random::integer());
+		checkOutputStream(Random::real(-1e9, 1e9));
+	}
+
+	// manipulators change the formatting
+	std::ostringstream expected, given;
+	expected << std::boolalpha << std::fixed << std::setprecision(DEFAULT_PRECISION);
+	expected << std::setprecision(2) << 1.125l << ' ' << std::hex << 255 << ' ' << std::setw(5) << 7 << std::dec << std::scientific << 0.5;
+	OutputStream(given) << std::setprecision(2) << 1.125l << ' ' << std::hex << 255 << ' ' << std::setw(5) << 7 << std::dec << std::scientific << 0.5;
+	assert(given.str() == expected.str());
+
+	// files are buffered and written in chunks
+	auto path = std::filesystem::temp_directory_path() / "validate_output.out";
+	std::ostringstream content;
+	content << std::fixed << std::setprecision(DEFAULT_PRECISION);
+	{
+		OutputStream file(path, std::ios::out);
+		for (Integer i = 0; i < 100'000; i++) {
+			file << i << ' ' << i / 7.0l << '\n';
+			content << i << ' ' << i / 7.0l << '\n';
+		}
+	}
+	assert(details::readFile(path) == content.str());
+	std::filesystem::remove(path);
+
+	// unbuffered streams only start a round if something was written
+	std::ostringstream unbuffered;
+	OutputStream out(unbuffered);
+	details::RoundTimer timer;
+	out.timeRounds(&timer);
+	out.flush();
+	out.received("0");
+	assert(timer.rounds() == 0);
+	out << 1 << '\n' << FLUSH;
+	out.received("1");
+	out.flush();
+	out.received("2");
+	assert(timer.rounds() == 1);
+	assert(unbuffered.str() == "1\n");
+
+#ifndef STREAM_FALLBACK
+	// output to std::cout keeps its order with direct writes unless buffering is enabled
+	auto mixed = std::filesystem::temp_directory_path() / "validate_mixed.out";
+	pid_t child = ::fork();
+	assert(child >= 0);
+	if (child == 0) {
+		int fd = ::open(mixed.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		::dup2(fd, STDOUT_FILENO);
+		::close(fd);
+		OutputStream testOut(std::cout);
+		testOut << 1 << ' ';
+		std::cout << 2 << ' ';
+		std::printf("3 ");
+		testOut << 4.5 << ' ' << "5\n";
+		std::cout << "6" << std::endl;
+		testOut.useBuffer();
+		testOut << 7 << '\n' << FLUSH;
+		std::printf("8\n");
+		std::fflush(stdout);
+		::_exit(0);
+	}
+	int status = 0;
+	assert(::waitpid(child, &status, 0) == child and WIFEXITED(status) and WEXITSTATUS(status) == 0);
+	assert(details::readFile(mixed) == "1 2 3 4.500000 5\n6\n7\n8\n");
+	std::filesystem::remove(mixed);
+#endif
+}
+
+void checkCinTie() {
+#ifndef STREAM_FALLBACK
+	// std::cin is read with read(), but std::cout must still be flushed before
+	int query[2], answer[2];
+	assert(::pipe(query) == 0 and ::pipe(answer) == 0);
+	pid_t child = ::fork();
+	assert(child >= 0);
+	if (child == 0) {
+		::dup2(answer[0], STDIN_FILENO);
+		::dup2(query[1], STDOUT_FILENO);
+		::close(query[0]);
+		::close(query[1]);
+		::close(answer[0]);
+		::close(answer[1]);
+		try {
+			InputStream in(std::cin, false, true, ValidateBase::juryOut, Verdicts::Verdict(23));
+			in.limitWaitTime(5'000);
+			std::cout << 7 << '\n';
+			::_exit(in.integer() == 7 ? 0 : 1);
+		} catch (int) {
+			::_exit(2);
+		}
+	}
+	::close(query[1]);
+	::close(answer[0]);
+	std::string line;
+	for (char c; ::read(query[0], &c, 1) == 1 and c != '\n';) line.push_back(c);
+	assert(line == "7");
+	assert(details::writeAll(answer[1], "7\n"));
+	int status = 0;
+	assert(::waitpid(child, &status, 0) == child and WIFEXITED(status) and WEXITSTATUS(status) == 0);
+	::close(query[0]);
+	::close(answer[1]);
+#endif
+}
+
+void checkInteraction() {
+#ifndef STREAM_FALLBACK
+	// a team which echoes every line
+	int toTeam[2], fromTeam[2];
+	assert(::pipe(toTeam) == 0 and ::pipe(fromTeam) == 0);
+	pid_t team = ::fork();
+	assert(team >= 0);
+	if (team == 0) {
+		::close(toTeam[1]);
+		::close(fromTeam[0]);
+		std::array<char, 1 << 12> buffer;
+		for (ssize_t read; (read = ::read(toTeam[0], buffer.data(), buffer.size())) > 0;) {
+			if (!details::writeAll(fromTeam[1], std::string_view(buffer.data(), static_cast<std::size_t>(read)))) break;
+		}
+		::_exit(0);
+	}
+	::close(toTeam[0]);
+	::close(fromTeam[1]);
+	{
+		std::ostringstream unused;
+		OutputStream out(unused, toTeam[1]);
+		out.useBuffer();
+		InputStream in("/dev/fd/" + std::to_string(fromTeam[0]), false, true, ValidateBase::juryOut, Verdicts::FAIL);
+		::close(fromTeam[0]);
+		for (Integer i = 0; i < 10'000; i++) {
+			out << i << ' ' << -i << '\n' << FLUSH;
+			assert(in.integer() == i);
+			assert(in.integer() == -i);
+			out << "x" << std::endl;
+			assert(in.string() == "x");
+		}
+		// the tie flushes before reading blocks
+		in.tie(out);
+		out << 0.5 << '\n';
+		assert(in.real() == 0.5);
+		assert(unused.str().empty());
+
+		auto path = std::filesystem::temp_directory_path() / "validate_rounds.bin";
+		{
+			details::RoundTimer timer(path);
+			out.timeRounds(&timer);
+			for (Integer i = 0; i < 1'000; i++) {
+				out << i << '\n';
+				assert(in.integer() == i);
+			}
+			out.timeRounds(nullptr);
+			assert(timer.rounds() == 1'000);
+			assert(timer.summary().find("rounds: 1000, ") == 0);
+		}
+		assert(std::filesystem::file_size(path) == 1'000 * 2 * sizeof(std::int64_t));
+		std::filesystem::remove(path);
+	}
+	::close(toTeam[1]);
+	int status = 0;
+	assert(::waitpid(team, &status, 0) == team and WIFEXITED(status));
+
+	// a team which stalls after its first answer
+	int stalled[2];
+	assert(::pipe(stalled) == 0);
+	team = ::fork();
+	assert(team >= 0);
+	if (team == 0) {
+		::close(stalled[0]);
+		assert(details::writeAll(stalled[1], "1\n"));
+		while (true) ::pause();
+	}
+	::close(stalled[1]);
+	{
+		std::ostringstream message;
+		OutputStream messageOut(message);
+		InputStream in("/dev/fd/" + std::to_string(stalled[0]), false, true, messageOut, Verdicts::Verdict(23));
+		::close(stalled[0]);
+		in.limitWaitTime(50);
+		assert(in.integer() == 1);
+		auto start = std::chrono::steady_clock::now();
+		assertExit([&](){in.integer();}, 23);
+		assert(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+		assert(message.str().find("No response within 50 ms, did you flush?") != std::string::npos);
+	}
+	::kill(team, SIGKILL);
+	assert(::waitpid(team, &status, 0) == team);
+#endif
+}
+
+void checkTranscript() {
+	auto path = std::filesystem::temp_directory_path() / "validate_transcript.bin";
+	{
+		details::TranscriptWriter transcript(path);
+		std::ostringstream rawOut;
+		OutputStream out(rawOut);
+		out.recordTranscript(&transcript);
+		std::istringstream rawIn("4\n");
+		InputStream in(rawIn, false, true, ValidateBase::juryOut, Verdicts::FAIL);
+		in.tie(out);
+		out << 2 << ' ' << std::setw(2) << 2 << std::endl;
+		assert(in.integer() == 4);
+		out << "correct" << std::endl;
+		assert(rawOut.str() == "2  2\ncorrect\n");
+	}
+	auto replay = [&](std::string_view query){
+		Interactor::details::Replay transcript(path);
+		OutputStream out(transcript.toTeam);
+		InputStream in(transcript.fromTeam, false, true, ValidateBase::juryOut, Verdicts::WA);
+		in.tie(out);
+		out << query;
+		assert(in.integer() == 4);
+		out << "correct" << std::endl;
+		in.eof();
+	};
+	assertNoException([&](){replay("2  2\n");});
+	assertExit([&](){replay("2  3\n");}, Verdicts::FAIL);
+	assertExit([&](){replay("2  ");}, Verdicts::FAIL);
+	// the replay must not end early
+	auto truncated = [&](bool read, std::string_view end){
+		Interactor::details::Replay transcript(path);
+		OutputStream out(transcript.toTeam);
+		InputStream in(transcript.fromTeam, false, true, ValidateBase::juryOut, Verdicts::WA);
+		in.tie(out);
+		out << "2  2\n" << FLUSH;
+		if (read) assert(in.integer() == 4);
+		out << end << FLUSH;
+		return transcript.incomplete();
+	};
+	assert(!truncated(true, "correct\n"));
+	assert(truncated(true, "correct") == "Replay: toTeam ended after 12 of 13 bytes of the transcript");
+	assert(truncated(true, "") == "Replay: toTeam ended after 5 of 13 bytes of the transcript");
+	assert(truncated(false, "correct\n") == "Replay: fromTeam read only 0 of 1 responses of the transcript");
+	// an incomplete replay turns the verdict into FAIL
+	auto verdict = [&](std::string_view end, Verdicts::Verdict v){
+		Interactor::details::replay = std::make_unique<Interactor::details::Replay>(path);
+		Verdicts::Verdict::beforeExit = Interactor::details::finishReplay;
+		OutputStream out(Interactor::details::replay->toTeam);
+		InputStream in(Interactor::details::replay->fromTeam, false, true, ValidateBase::juryOut, Verdicts::WA);
+		in.tie(out);
+		out << "2  2\n" << FLUSH;
+		assert(in.integer() == 4);
+		out << end << FLUSH;
+		int res = -1;
+		try {
+			ValidateBase::juryOut << v;
+		} catch (int exitCode) {
+			res = exitCode;
+		}
+		Verdicts::Verdict::beforeExit = nullptr;
+		Interactor::details::replay.reset();
+		return res;
+	};
+	assert(verdict("correct\n", Verdicts::AC) == Verdicts::AC);
+	assert(verdict("correct\n", Verdicts::WA) == Verdicts::WA);
+	assert(verdict("", Verdicts::AC) == Verdicts::FAIL);
+	assert(verdict("", Verdicts::WA) == Verdicts::FAIL);
+	std::filesystem::remove(path);
+}
+
+static_assert(!std::is_same_v<InputPolicy::SpaceSensitive, InputPolicy::CaseSensitive>, "policies of different dimensions must differ!");
+
 template<typename T, typename = void>
 struct CompileJoin : std::false_type {};
 
@@ -607,6 +1528,279 @@ struct CompileJoin<T, std::void_t<decltype(join(std::declval<T>()))>> : std::tru
 
 static_assert(!CompileJoin<int>{}, "join(int) should be invalid!");
 
+void checkServer() {
+#ifndef STREAM_FALLBACK
+	auto directory = std::filesystem::temp_directory_path() / "validate_server";
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directory(directory);
+	std::string socketPath = (directory / "socket").string();
+	std::ofstream(directory / "ac.out") << "42\n";
+	std::ofstream(directory / "wa.out") << "7\n";
+	std::string name = "validator", in = "in", ans = "ans", feedback = "feedback";
+	char* argv[] = {name.data(), in.data(), ans.data(), feedback.data()};
+	auto start = [&]() {
+		pid_t server = ::fork();
+		assert(server >= 0);
+		if (server == 0) {
+			// the server must not outlive a failed test
+			::alarm(60);
+			try {
+				OutputValidator::details::serve(4, argv, socketPath);
+				// a request: accepts "42" if the feedback dir was passed on
+				InputStream team(std::cin, false, true, ValidateBase::juryOut, Verdicts::WA);
+				bool ok = team.integer() == 42 and ValidateBase::arguments[3] == directory.string();
+				::_exit(ok ? 42 : 43);
+			} catch (int) {
+				::_exit(2);
+			}
+		}
+		return server;
+	};
+	pid_t server = start();
+	auto request = [&](const std::string& teamOutput) {
+		sockaddr_un address = {};
+		address.sun_family = AF_UNIX;
+		std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+		int connection = -1;
+		for (int i = 0; i < 500 and connection < 0; i++) {
+			connection = ::socket(AF_UNIX, SOCK_STREAM, 0);
+			assert(connection >= 0);
+			if (::connect(connection, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+				::close(connection);
+				connection = -1;
+				::usleep(10'000);
+			}
+		}
+		assert(connection >= 0);
+		assert(details::writeAll(connection, teamOutput + "\n" + directory.string() + "\n"));
+		std::string reply;
+		for (char c; ::read(connection, &c, 1) == 1;) reply.push_back(c);
+		::close(connection);
+		return reply;
+	};
+	assert(request((directory / "ac.out").string()) == "42\n");
+	assert(request((directory / "wa.out").string()) == "43\n");
+	// a missing team output is answered instead of aborting
+	assert(request((directory / "missing.out").string()) == "1\n");
+	auto message = details::readFile(directory / JUDGE_MESSAGE);
+	assert(message and message->find("missing.out") != std::string::npos);
+	assert(request((directory / "ac.out").string()) == "42\n");
+	// neither the socket of a live server nor any other file is replaced
+	auto rejected = [&](const std::string& path) {
+		try {
+			OutputValidator::details::serve(4, argv, path);
+		} catch (const std::runtime_error&) {
+			return true;
+		}
+		return false;
+	};
+	assert(rejected(socketPath));
+	assert(rejected((directory / "wa.out").string()));
+	assert(details::readFile(directory / "wa.out") == "7\n");
+	assert(request((directory / "ac.out").string()) == "42\n");
+	::kill(server, SIGTERM);
+	int status = 0;
+	assert(::waitpid(server, &status, 0) == server);
+	// the stale socket of a stopped server is replaced
+	assert(std::filesystem::is_socket(socketPath));
+	server = start();
+	assert(request((directory / "wa.out").string()) == "43\n");
+	::kill(server, SIGTERM);
+	assert(::waitpid(server, &status, 0) == server);
+	std::filesystem::remove_all(directory);
+#endif
+}
+
+void checkBatch() {
+#ifndef STREAM_FALLBACK
+	auto directory = std::filesystem::temp_directory_path() / "validate_batch";
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directories(directory / "empty");
+	for (int i = 0; i < 6; i++) std::ofstream(directory / ("test" + std::to_string(i) + ".in")) << i << "\n";
+	// runs a validator that accepts even numbers on every file of source
+	auto run = [&](const std::filesystem::path& source, Integer jobs) {
+		auto report = directory / "report.txt";
+		pid_t child = ::fork();
+		assert(child >= 0);
+		if (child == 0) {
+			int fd = ::open(report.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+			::dup2(fd, STDOUT_FILENO);
+			::close(fd);
+			std::string name = "validator";
+			char* argv[] = {name.data()};
+			try {
+				InputValidator::details::batch(1, argv, source, jobs);
+				InputStream in(std::cin, true, true, ValidateBase::juryOut, Verdicts::WA);
+				Integer x = in.integer();
+				int fds = 0;
+				for (int fd = 0; fd < 1024; fd++) {
+					if (::fcntl(fd, F_GETFD) != -1) fds++;
+				}
+				std::cout << "read " << x << "\nfds " << fds << std::endl;
+				::_exit(x % 2 == 0 ? 42 : 43);
+			} catch (int code) {
+				::_exit(code);
+			}
+		}
+		int status = 0;
+		assert(::waitpid(child, &status, 0) == child and WIFEXITED(status));
+		std::string res = *details::readFile(report);
+		// every child must see the same open files
+		std::set<std::string> fds;
+		std::string withoutFds;
+		std::istringstream lines(res);
+		for (std::string line; std::getline(lines, line);) {
+			if (line.substr(0, 4) == "fds ") fds.insert(line);
+			else withoutFds += line + "\n";
+		}
+		assert(fds.size() <= 1);
+		return std::make_pair(WEXITSTATUS(status), withoutFds);
+	};
+	std::string expected;
+	for (int i = 0; i < 6; i++) {
+		expected += (directory / ("test" + std::to_string(i) + ".in")).string() + ": " + (i % 2 == 0 ? "42" : "43");
+		expected += "\nread " + std::to_string(i) + "\n";
+	}
+	for (Integer jobs : {1, 3, 10}) {
+		auto [code, report] = run(directory, jobs);
+		assert(code == 43);
+		assert(report == expected);
+	}
+	// a missing file fails without stopping the others
+	std::ofstream(directory / "list.txt") << (directory / "test0.in").string() << "\n"
+	                                      << (directory / "missing.in").string() << "\n"
+	                                      << (directory / "test2.in").string() << "\n";
+	auto [code, report] = run(directory / "list.txt", 2);
+	assert(code == 1);
+	expected = (directory / "test0.in").string() + ": 42\nread 0\n";
+	expected += (directory / "missing.in").string() + ": 1\n";
+	expected += "InputValidator: Could not open File: " + (directory / "missing.in").string() + "\n";
+	expected += (directory / "test2.in").string() + ": 42\nread 2\n";
+	assert(report == expected);
+	// an empty source is rejected
+	bool rejected = false;
+	try {
+		InputValidator::details::batch(0, nullptr, directory / "empty", 1);
+	} catch (const std::invalid_argument&) {
+		rejected = true;
+	}
+	assert(rejected);
+	std::filesystem::remove_all(directory);
+#endif
+}
+
+void checkMemo() {
+#ifndef STREAM_FALLBACK
+	auto directory = std::filesystem::temp_directory_path() / "validate_memo";
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directories(directory / "batch");
+	auto memo = directory / "memo";
+	auto runs = directory / "runs.txt";
+	auto constraints = (directory / "constraints").string();
+	std::ofstream(directory / "a.in") << "4\n";
+	std::ofstream(directory / "b.in") << "5\n";
+	std::ofstream(directory / "batch" / "test0.in") << "0\n";
+	std::ofstream(directory / "batch" / "test1.in") << "1\n";
+	// runs a memoized validator that accepts even numbers and logs each actual run
+	auto report = directory / "report.txt";
+	auto errors = directory / "errors.txt";
+	auto run = [&](std::vector<std::string> args, const std::optional<std::filesystem::path>& input) {
+		pid_t child = ::fork();
+		assert(child >= 0);
+		if (child == 0) {
+			int fd = ::open(report.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+			::dup2(fd, STDOUT_FILENO);
+			::close(fd);
+			fd = ::open(errors.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+			::dup2(fd, STDERR_FILENO);
+			::close(fd);
+			if (input) {
+				fd = ::open(input->c_str(), O_RDONLY);
+				::dup2(fd, STDIN_FILENO);
+				::close(fd);
+			}
+			ValidateBase::details::setArguments(args);
+			try {
+				if (auto source = ValidateBase::arguments[BATCH_COMMAND]) {
+					std::vector<char*> argv;
+					for (auto& arg : args) argv.push_back(arg.data());
+					InputValidator::details::batch(static_cast<int>(argv.size()), argv.data(), source.asString(), ValidateBase::arguments[JOBS_COMMAND].asInteger(1));
+				}
+				InputValidator::details::memoize(ValidateBase::arguments[MEMO_COMMAND].asString());
+				InputStream in(std::cin, true, true, ValidateBase::juryOut, Verdicts::WA);
+				Integer x = in.integer();
+				std::ofstream(runs, std::ios::app) << x << "\n";
+				std::cout << "read " << x << std::endl;
+				std::cerr << "err " << x << std::endl;
+				std::ofstream(ValidateBase::arguments[CONSTRAINT_COMMAND].asString()) << "x " << x << "\n";
+				::_exit(x % 2 == 0 ? 42 : 43);
+			} catch (int code) {
+				::_exit(code);
+			}
+		}
+		int status = 0;
+		assert(::waitpid(child, &status, 0) == child and WIFEXITED(status));
+		return std::make_pair(WEXITSTATUS(status), *details::readFile(report));
+	};
+	auto countRuns = [&]() {
+		auto log = details::readFile(runs);
+		return log ? std::count(log->begin(), log->end(), '\n') : 0;
+	};
+#if defined(__linux__) || defined(__APPLE__)
+	assert(details::binaryHash().has_value());
+#endif
+	// without a hash of the binary nothing is memoized and every run is a miss
+	bool memoized = details::binaryHash().has_value();
+	std::ptrdiff_t misses = 0;
+	std::vector<std::string> args = {"validator", std::string(CONSTRAINT_COMMAND), constraints, std::string(MEMO_COMMAND), memo.string()};
+	// a miss runs the validator and records it
+	assert(run(args, directory / "a.in") == std::make_pair(42, std::string("read 4\n")));
+	assert(countRuns() == ++misses);
+	assert(details::readFile(constraints) == "x 4\n");
+	assert(details::readFile(errors) == "err 4\n");
+	// a hit replays messages, errors, and constraints
+	std::filesystem::remove(constraints);
+	assert(run(args, directory / "a.in") == std::make_pair(42, std::string("read 4\n")));
+	if (!memoized) misses++;
+	assert(countRuns() == misses);
+	assert(details::readFile(constraints) == "x 4\n");
+	assert(details::readFile(errors) == "err 4\n");
+	// other inputs or arguments miss
+	assert(run(args, directory / "b.in") == std::make_pair(43, std::string("read 5\n")));
+	assert(countRuns() == ++misses);
+	assert(details::readFile(constraints) == "x 5\n");
+	auto other = args;
+	other.push_back("--other");
+	assert(run(other, directory / "a.in") == std::make_pair(42, std::string("read 4\n")));
+	assert(countRuns() == ++misses);
+	// in batch mode, each file is memoized with its own constraints file
+	// the number of jobs does not matter, in batch mode stderr is part of the report
+	std::string expected;
+	expected += (directory / "batch" / "test0.in").string() + ": 42\nread 0\nerr 0\n";
+	expected += (directory / "batch" / "test1.in").string() + ": 43\nread 1\nerr 1\n";
+	for (int i = 0; i < 2; i++) {
+		auto batch = args;
+		batch.push_back(std::string(BATCH_COMMAND));
+		batch.push_back((directory / "batch").string());
+		batch.push_back(std::string(JOBS_COMMAND));
+		batch.push_back(std::to_string(2 + 2 * i));
+		std::filesystem::remove(constraints + ".0");
+		std::filesystem::remove(constraints + ".1");
+		assert(run(batch, std::nullopt) == std::make_pair(43, expected));
+		if (i == 0 or !memoized) misses += 2;
+		assert(countRuns() == misses);
+		assert(details::readFile(constraints + ".0") == "x 0\n");
+		assert(details::readFile(constraints + ".1") == "x 1\n");
+	}
+	// a standalone run shares the memo of the batch run
+	assert(run(args, directory / "batch" / "test0.in") == std::make_pair(42, std::string("read 0\n")));
+	if (!memoized) misses++;
+	assert(countRuns() == misses);
+	assert(details::readFile(errors) == "err 0\n");
+	std::filesystem::remove_all(directory);
+#endif
+}
+
 void checkGeometry() {
 	using pts = std::vector<std::pair<Integer, Integer>>;
 	assert(!isConvex(pts{}));
@@ -679,7 +1873,20 @@ int main() {
 	checkRandom();
 	checkCommandParser();
 	checkInputStream();
+	checkExpectSame();
+	checkExpectReals();
+	checkTokenCache();
+	checkIntegerParser();
+	checkRealParser();
+	checkTokenPattern();
 	checkJoin();
+	checkOutputStream();
+	checkCinTie();
+	checkInteraction();
+	checkTranscript();
+	checkServer();
+	checkBatch();
+	checkMemo();
 	checkGeometry();
 
 	std::cout << "All tests passed!" << std::endl;